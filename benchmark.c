@@ -0,0 +1,131 @@
+// This is not part of the simulator. It measures the throughput of the main
+// loop of the simulation (simulated time units per second of wall-clock time)
+// on a synthetic workload.
+// To compile, you can run: make bench and then run
+// ./benchmark [NB_PROCESSES] [NB_TIME_UNITS] [--event-driven]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "simulation.h"
+#include "stats.h"
+#include "utils.h"
+#include "schedulingAlgorithms.h"
+
+#define DEFAULT_NB_PROCESSES 100000
+#define DEFAULT_NB_TIME_UNITS 2000
+#define NB_CORES 16
+#define ARRIVALS_PER_TIME_UNIT 4
+#define WORKLOAD_FILE "benchmark_workload.txt"
+
+/**
+ * Write a synthetic workload: ARRIVALS_PER_TIME_UNIT processes arrive at each
+ * time unit, each with a single CPU burst of 1 to 3 time units. The load stays
+ * below the capacity of the NB_CORES cores, so the ready queue stays short and
+ * the cost of a time unit is dominated by the passes over all the processes.
+ *
+ * @param fileName The file to write the workload to.
+ * @param nbProcesses The number of processes of the workload.
+ *
+ * @return true on success, false otherwise.
+ */
+static bool writeSyntheticWorkload(const char *fileName, int nbProcesses)
+{
+    FILE *file = fopen(fileName, "w");
+    if (!file)
+    {
+        fprintf(stderr, "Error: could not create file %s\n", fileName);
+        return false;
+    }
+
+    fprintf(file, "# pid, start_time, duration, priority, [list of timestamps and events] (IO, CPU)\n");
+    uint32_t seed = 42;
+    for (int pid = 1; pid <= nbProcesses; pid++)
+    {
+        seed = seed * 1664525u + 1013904223u; // deterministic LCG
+        int duration = 1 + (seed >> 16) % 3;
+        fprintf(file, "%d, %d, %d, %d, [(0, CPU)]\n", pid, (pid - 1) / ARRIVALS_PER_TIME_UNIT, duration, (int) ((seed >> 8) % 5));
+    }
+
+    fclose(file);
+    return true;
+}
+
+/**
+ * Main function.
+ * Generates the synthetic workload, simulates it with a FCFS ready queue on
+ * NB_CORES cores during NB_TIME_UNITS and prints the throughput.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ *
+ * @return The exit status.
+ */
+int main(int argc, const char *argv[])
+{
+    SimulationOptions options;
+    setDefaultSimulationOptions(&options);
+
+    int nbProcesses = DEFAULT_NB_PROCESSES;
+    int64_t nbTimeUnits = DEFAULT_NB_TIME_UNITS;
+    int positional = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--event-driven") == 0)
+            options.eventDriven = true;
+        else if (positional++ == 0)
+            nbProcesses = atoi(argv[i]);
+        else
+            nbTimeUnits = strtoll(argv[i], NULL, 10);
+    }
+    options.maxTime = nbTimeUnits - 1;
+
+    if (!writeSyntheticWorkload(WORKLOAD_FILE, nbProcesses))
+    {
+        return EXIT_FAILURE;
+    }
+
+    double parseStart = getWallClockTime();
+    Workload *workload = parseInputFile(WORKLOAD_FILE);
+    double parseTime = getWallClockTime() - parseStart;
+    remove(WORKLOAD_FILE);
+    if (!workload)
+    {
+        return EXIT_FAILURE;
+    }
+
+    AllStats *stats = initStats();
+    SchedulingAlgorithm **algorithms = (SchedulingAlgorithm **) malloc(sizeof(SchedulingAlgorithm *));
+    if (!stats || !algorithms)
+    {
+        fprintf(stderr, "Error: could not allocate memory for the benchmark\n");
+        freeStats(stats);
+        free(algorithms);
+        freeWorkload(workload);
+        return EXIT_FAILURE;
+    }
+    algorithms[0] = initSchedulingAlgorithm(FCFS, NO_LIMIT, NO_LIMIT, NO_LIMIT);
+
+    // no graph: it is limited to a few processes and only slows down the loop
+    double simulationStart = getWallClockTime();
+    bool success = launchSimulation(workload, algorithms, 1, NB_CORES, NULL, stats, &options);
+    double simulationTime = getWallClockTime() - simulationStart;
+    if (!success)
+    {
+        freeStats(stats);
+        freeWorkload(workload);
+        return EXIT_FAILURE;
+    }
+
+    printf("processes: %d, time units: %" PRId64 ", mode: %s\n", nbProcesses, nbTimeUnits,
+           options.eventDriven ? "event-driven" : "unit ticks");
+    printf("parsing: %.3f s\n", parseTime);
+    printf("simulation: %.3f s (%.0f time units/s)\n", simulationTime, nbTimeUnits / simulationTime);
+
+    freeStats(stats);
+    freeWorkload(workload);
+
+    return EXIT_SUCCESS;
+}
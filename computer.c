@@ -10,8 +10,9 @@
 #include "schedulingLogic.h"
 
 #define INTERRUPT_TIME 1
+#define CORE_WORD_BITS 64 // cores per word of the bitmaps of the core states
 
-Computer *initComputer(Scheduler *scheduler, CPU *cpu, Disk *disk)
+Computer *initComputer(Scheduler *scheduler, CPU *cpu, Disk *disk, unsigned int seed)
 {
     Computer *computer = (Computer *) malloc(sizeof(Computer));
     if (!computer)
@@ -21,6 +22,7 @@ Computer *initComputer(Scheduler *scheduler, CPU *cpu, Disk *disk)
     computer->scheduler = scheduler;
     computer->cpu = cpu;
     computer->disk = disk;
+    seedRandomGenerator(&computer->random, seed);
     return computer;
 }
 
@@ -40,51 +42,132 @@ CPU *initCPU(int coreCount)
         return NULL;
     }
 
-    cpu->cores = malloc(coreCount * sizeof(Core *));
-    if (!cpu->cores)
+    cpu->nbCoreWords = (coreCount + CORE_WORD_BITS - 1) / CORE_WORD_BITS;
+    cpu->cores = malloc(coreCount * sizeof(Core));
+    cpu->coreStates = calloc(NB_CORE_STATES * cpu->nbCoreWords, sizeof(uint64_t));
+    if (!cpu->cores || !cpu->coreStates)
     {
+        free(cpu->cores);
+        free(cpu->coreStates);
         free(cpu);
         return NULL;
     }
 
+    cpu->coreCount = coreCount;
     for (int i = 0; i < coreCount; i++)
     {
-        cpu->cores[i] = malloc(sizeof(Core));
-        if (!cpu->cores[i])
-        {
-            for (int j = 0; j < i; j++)
-            {
-                free(cpu->cores[j]);
-            }
-            free(cpu->cores);
-            free(cpu);
-            return NULL;
-        }
-        cpu->cores[i]->state = IDLE;
-        cpu->cores[i]->processNode = NULL;
-        cpu->cores[i]->switchOutTimer = 0;
-        cpu->cores[i]->switchInTimer = 0;
-        cpu->cores[i]->interruptTimer = 0;
-        cpu->cores[i]->quantumTime = 0; // only used for RR
-        cpu->cores[i]->continueOnCPU = false;
+        cpu->cores[i].state = IDLE;
+        cpu->coreStates[IDLE * cpu->nbCoreWords + i / CORE_WORD_BITS] |= (uint64_t) 1 << (i % CORE_WORD_BITS);
+        cpu->cores[i].processNode = NULL;
+        cpu->cores[i].switchEnd = 0;
+        cpu->cores[i].interruptStart = 0;
+        cpu->cores[i].interruptEnd = 0;
+        cpu->cores[i].interruptedState = IDLE;
+        cpu->cores[i].sliceStart = 0; // only used for RR
+        cpu->cores[i].continueOnCPU = false;
     }
 
-    cpu->coreCount = coreCount;
-
     return cpu;
 }
 
 void freeCPU(CPU *cpu)
 {
-    for (int i = 0; i < cpu->coreCount; i++)
-    {
-        freeNode(cpu->cores[i]->processNode);
-        free(cpu->cores[i]);
-    }
     free(cpu->cores);
+    free(cpu->coreStates);
     free(cpu);
 }
 
+void setCoreState(CPU *cpu, int coreIndex, coreState state)
+{
+    uint64_t bit = (uint64_t) 1 << (coreIndex % CORE_WORD_BITS);
+    int word = coreIndex / CORE_WORD_BITS;
+    cpu->coreStates[cpu->cores[coreIndex].state * cpu->nbCoreWords + word] &= ~bit;
+    cpu->coreStates[state * cpu->nbCoreWords + word] |= bit;
+    cpu->cores[coreIndex].state = state;
+}
+
+int firstCoreInState(const CPU *cpu, coreState state)
+{
+    return nextCoreInState(cpu, state, -1);
+}
+
+int nextCoreInState(const CPU *cpu, coreState state, int coreIndex)
+{
+    const uint64_t *bitmap = &cpu->coreStates[state * cpu->nbCoreWords];
+    int start = coreIndex + 1;
+    if (start >= cpu->coreCount)
+        return -1;
+    //the bits of the cores up to coreIndex are masked in the first word
+    int word = start / CORE_WORD_BITS;
+    uint64_t bits = bitmap[word] & (~(uint64_t) 0 << (start % CORE_WORD_BITS));
+    while (!bits)
+    {
+        if (++word == cpu->nbCoreWords)
+            return -1;
+        bits = bitmap[word];
+    }
+    return word * CORE_WORD_BITS + findFirstSet64(bits);
+}
+
+int lastCoreInState(const CPU *cpu, coreState state)
+{
+    return prevCoreInState(cpu, state, cpu->coreCount);
+}
+
+int prevCoreInState(const CPU *cpu, coreState state, int coreIndex)
+{
+    const uint64_t *bitmap = &cpu->coreStates[state * cpu->nbCoreWords];
+    int start = coreIndex - 1;
+    if (start < 0)
+        return -1;
+    //the bits of the cores from coreIndex are masked in the first word
+    int word = start / CORE_WORD_BITS;
+    uint64_t bits = bitmap[word] & (~(uint64_t) 0 >> (CORE_WORD_BITS - 1 - start % CORE_WORD_BITS));
+    while (!bits)
+    {
+        if (--word < 0)
+            return -1;
+        bits = bitmap[word];
+    }
+    return word * CORE_WORD_BITS + findLastSet64(bits);
+}
+
+int firstBusyCore(const CPU *cpu)
+{
+    return nextBusyCore(cpu, -1);
+}
+
+int nextBusyCore(const CPU *cpu, int coreIndex)
+{
+    int start = coreIndex + 1;
+    if (start >= cpu->coreCount)
+        return -1;
+    //a core is busy if its bit is set in the bitmap of any state but IDLE
+    int word = start / CORE_WORD_BITS;
+    uint64_t mask = ~(uint64_t) 0 << (start % CORE_WORD_BITS);
+    for (; word < cpu->nbCoreWords; word++, mask = ~(uint64_t) 0)
+    {
+        uint64_t bits = 0;
+        for (int state = 0; state < NB_CORE_STATES; state++)
+        {
+            if (state != IDLE)
+                bits |= cpu->coreStates[state * cpu->nbCoreWords + word];
+        }
+        bits &= mask;
+        if (bits)
+            return word * CORE_WORD_BITS + findFirstSet64(bits);
+    }
+    return -1;
+}
+
+int countCoresInState(const CPU *cpu, coreState state)
+{
+    int count = 0;
+    for (int i = 0; i < cpu->nbCoreWords; i++)
+        count += countSetBits64(cpu->coreStates[state * cpu->nbCoreWords + i]);
+    return count;
+}
+
 Disk *initDisk(void)
 {
     Disk *disk = malloc(sizeof(Disk));
@@ -101,31 +184,35 @@ Disk *initDisk(void)
 
 void freeDisk(Disk *disk)
 {
-    freeNode(disk->processNode);
     free(disk);
 }
 
 //need args
-void handleInterrupt(Computer *computer, Workload *workload)
+bool handleInterrupt(Computer *computer, SimulationState *state)
 {
     int interruptTimer = INTERRUPT_TIME;
     if (interruptTimer > 0)
     {
         computer->disk->state = DISK_IDLE;
-        int core = rand() % (computer->cpu->coreCount); //should choose randomly one core for fairness ("no notion of core affinity")
-        computer->cpu->cores[core]->state = INTERRUPTED;
-        computer->cpu->cores[core]->interruptTimer = interruptTimer; // start timer
-        if (computer->cpu->cores[core]->processNode)
-            computer->cpu->cores[core]->processNode->pcb->state = READY; //stays on the core to be able to "restart" when interrupt ended
+        int core = nextRandom(&computer->random) % (computer->cpu->coreCount); //should choose randomly one core for fairness ("no notion of core affinity")
+        int64_t time = getSchedulerTime(computer->scheduler);
+        computer->cpu->cores[core].interruptedState = computer->cpu->cores[core].state;
+        setCoreState(computer->cpu, core, INTERRUPTED);
+        computer->cpu->cores[core].interruptStart = time;
+        computer->cpu->cores[core].interruptEnd = time + interruptTimer; // start timer
+        if (computer->cpu->cores[core].processNode)
+            computer->cpu->cores[core].processNode->pcb->state = READY; //stays on the core to be able to "restart" when interrupt ended
     }
     else
     { //no interrupt: no need to interrupt a core
         computer->disk->state = DISK_IDLE;
         //the process that was waiting for the IO operation to complete will be put back on the ready queue.
         computer->disk->processNode->pcb->state = READY;
-        advanceNextEvent(workload, computer->disk->processNode->pcb->pid); //schedulingLogic should not use the workload, but here thee is no other choice, we need to update the next event
-        handleProcessForCPU(computer->scheduler, computer->disk->processNode);
+        advanceNextEvent(state, computer->disk->processNode->pcb->pid); //schedulingLogic should not use the workload, but here thee is no other choice, we need to update the next event
+        if (!handleProcessForCPU(computer->scheduler, computer->disk->processNode))
+            return false;
+        computer->disk->processNode->onDisk = false;
         computer->disk->processNode = NULL;
     }
-    return;
+    return true;
 }
\ No newline at end of file
@@ -2,10 +2,12 @@
 #define computer_h
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "process.h"
 #include "schedulingAlgorithms.h"
 #include "schedulingLogic.h"
+#include "utils.h"
 
 #define SWITCH_OUT_DURATION 2 // Duration of the context switch out
 #define SWITCH_IN_DURATION 1 // Duration of the context switch in
@@ -30,6 +32,7 @@ struct Computer_t
     Scheduler *scheduler;
     CPU *cpu;
     Disk *disk;
+    RandomGenerator random; // own generator: the simulations do not share any state
 };
 
 
@@ -47,6 +50,8 @@ typedef enum
     IDLE
 } coreState;
 
+#define NB_CORE_STATES (IDLE + 1)
+
 /* ------------------------------- Cpu struct ------------------------------ */
 /**
  * @struct CPU_t
@@ -55,9 +60,13 @@ typedef enum
  */
 struct CPU_t
 {
-    // list of cores
-    Core **cores;
+    // list of cores, stored contiguously
+    Core *cores;
     int coreCount;
+    // one bitmap of nbCoreWords words per core state: bit i % 64 of word i / 64
+    // of the bitmap of a state is set if the core i is in that state
+    uint64_t *coreStates;
+    int nbCoreWords;
 };
 
 /* ------------------------------- Core struct ------------------------------ */
@@ -71,10 +80,13 @@ struct Core_t
 {
     coreState state;
     Node *processNode;
-    int switchInTimer; //0 when not in switch in
-    int switchOutTimer; //0 when not in switch out
-    int interruptTimer; //0 when not during an interrupt
-    int quantumTime;
+    // the timers are absolute times: they are not advanced at each time unit,
+    // an interrupt delays the timers of the core by its duration
+    int64_t switchEnd; //time at which the current switch in or out ends
+    int64_t interruptStart; //time at which the current interrupt started
+    int64_t interruptEnd; //time at which the current interrupt ends
+    coreState interruptedState; //state of the core when the current interrupt started
+    int64_t sliceStart; //time at which the current RR time slice started
     bool continueOnCPU;
 };
 
@@ -92,7 +104,7 @@ struct Disk_t
  * For the CPU, it initializes the number of cores (coreCount) that will be used.
  */
 
-Computer *initComputer(Scheduler *scheduler, CPU *cpu, Disk *disk);
+Computer *initComputer(Scheduler *scheduler, CPU *cpu, Disk *disk, unsigned int seed);
 
 /**
  * Frees the memory allocated for a Computer object.
@@ -116,6 +128,89 @@ CPU *initCPU(int coreCount);
  */
 void freeCPU(CPU *cpu);
 
+/**
+ * Changes the state of a core. The state of the cores must only be changed
+ * through this function to keep the bitmaps of the core states up to date.
+ *
+ * @param cpu The CPU.
+ * @param coreIndex The index of the core.
+ * @param state The new state of the core.
+ */
+void setCoreState(CPU *cpu, int coreIndex, coreState state);
+
+/**
+ * Get the first core in a given state, with a bit scan.
+ *
+ * @param cpu The CPU.
+ * @param state The state.
+ *
+ * @return The index of the core, or -1 if no core is in that state.
+ */
+int firstCoreInState(const CPU *cpu, coreState state);
+
+/**
+ * Get the next core in a given state after a given core, with a bit scan.
+ *
+ * @param cpu The CPU.
+ * @param state The state.
+ * @param coreIndex The index of the core after which the search starts.
+ *
+ * @return The index of the core, or -1 if no core after coreIndex is in that state.
+ */
+int nextCoreInState(const CPU *cpu, coreState state, int coreIndex);
+
+/**
+ * Get the last core in a given state, with a bit scan.
+ *
+ * @param cpu The CPU.
+ * @param state The state.
+ *
+ * @return The index of the core, or -1 if no core is in that state.
+ */
+int lastCoreInState(const CPU *cpu, coreState state);
+
+/**
+ * Get the previous core in a given state before a given core, with a bit scan.
+ *
+ * @param cpu The CPU.
+ * @param state The state.
+ * @param coreIndex The index of the core before which the search starts.
+ *
+ * @return The index of the core, or -1 if no core before coreIndex is in that state.
+ */
+int prevCoreInState(const CPU *cpu, coreState state, int coreIndex);
+
+/**
+ * Get the first busy core (in any state but IDLE), with a bit scan of the
+ * bitmaps of the other states.
+ *
+ * @param cpu The CPU.
+ *
+ * @return The index of the core, or -1 if all the cores are idle.
+ */
+int firstBusyCore(const CPU *cpu);
+
+/**
+ * Get the next busy core (in any state but IDLE) after a given core, with a
+ * bit scan of the bitmaps of the other states.
+ *
+ * @param cpu The CPU.
+ * @param coreIndex The index of the core after which the search starts.
+ *
+ * @return The index of the core, or -1 if the cores after coreIndex are idle.
+ */
+int nextBusyCore(const CPU *cpu, int coreIndex);
+
+/**
+ * Get the number of cores in a given state.
+ *
+ * @param cpu The CPU.
+ * @param state The state.
+ *
+ * @return The number of cores.
+ */
+int countCoresInState(const CPU *cpu, coreState state);
+
 
 /**
  * Initializes a disk.
@@ -135,8 +230,10 @@ void freeDisk(Disk *disk);
  * Handles an interrupt for the given computer.
  *
  * @param computer The computer object to handle the interrupt for.
- * @param workload The workload to be able to advance to next event if interrup_duration = 0.
+ * @param state The state of the simulation to be able to advance to next event if interrup_duration = 0.
+ *
+ * @return False if the process of the disk could not be put in the ready queues.
  */
-void handleInterrupt(Computer *computer, Workload *workload);
+bool handleInterrupt(Computer *computer, SimulationState *state);
 
 #endif // computer_h
@@ -0,0 +1,48 @@
+// This is not part of the simulator. It converts a text input file to a
+// binary workload file, which cpuScheduler loads without parsing it.
+// To compile, you can run: make converter and then run
+// ./convertWorkload INPUT_FILE OUTPUT_FILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "simulation.h"
+#include "utils.h"
+
+/**
+ * Main function.
+ * Parses the text input file and saves it in the binary workload format.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ *
+ * @return The exit status.
+ */
+int main(int argc, const char *argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: ./convertWorkload INPUT_FILE OUTPUT_FILE\n");
+        return EXIT_FAILURE;
+    }
+
+    double parseStart = getWallClockTime();
+    Workload *workload = parseInputFile(argv[1]);
+    double parseTime = getWallClockTime() - parseStart;
+    if (!workload)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (!saveBinaryWorkload(workload, argv[2]))
+    {
+        freeWorkload(workload);
+        return EXIT_FAILURE;
+    }
+    printf("%d processes converted (parsing: %.3f s)\n", getProcessCount(workload), parseTime);
+
+    freeWorkload(workload);
+
+    return EXIT_SUCCESS;
+}
@@ -3,11 +3,13 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <inttypes.h>
 
 #include "graph.h"
+#include "utils.h"
 
-#define MAX_PROCESSES 100
-#define MAX_TIME_SLOTS 10000
+#define INITIAL_PROCESSES_CAPACITY 16
+#define NO_PROCESS -1
 
 #define WAITING_SYMBOL '.'
 #define READY_SYMBOL '-'
@@ -24,33 +26,45 @@ typedef struct Disk_t Disk;
 struct Event_t
 {
     char symbol;           // (= for RUNNING, . for WAITING, - for READY)
-    int time;              // Time at which the event occurs
+    int64_t time;          // Time at which the event occurs
     Event *nextEvent;      // Pointer to the next event in the queue
 };
 
+// Only the changes of symbol are stored: an event keeps its symbol until
+// the next one (or the end of the graph).
 struct Process_t
 {
     int processId;              // Process id
     Event *firstEvent;          // Pointer to first event in the queue
+    Event *lastEvent;           // Pointer to last event in the queue
 };
 
 struct Disk_t
 {
     Event *firstEvent;
+    Event *lastEvent;
 };
 
 struct ProcessGraph_t
 {
     int nbProcesses;
-    int nbTimeSlots;
-    Process processes[MAX_PROCESSES];
+    int64_t nbTimeSlots;
+    Process *processes;
+    int processesCapacity;
+    // process id -> index in processes: open-addressing hash table (linear
+    // probing) of size processesCapacity * 2, indexKeys[i] being the id
+    // stored in the slot i (NO_PROCESS in index if the slot is empty)
+    int *indexKeys;
+    int *index;
     Disk *disk;
 };
 
 
 /* ---------------------------- static functions --------------------------- */
 
-static Event *createNewEventForGraph(ProcessGraph *graph, int time);
+static int getProcessSlot(const ProcessGraph *graph, int processId);
+static bool growGraphProcesses(ProcessGraph *graph);
+static void addEventToList(ProcessGraph *graph, Event **firstEvent, Event **lastEvent, int64_t time, char symbol);
 static char idToSymbol(int id);
 
 
@@ -66,12 +80,18 @@ ProcessGraph *initGraph(void)
 
     graph->nbProcesses = 0;
     graph->nbTimeSlots = 0;
-    for (int i = 0; i < MAX_PROCESSES; i++)
+    graph->processes = NULL;
+    graph->processesCapacity = 0;
+    graph->indexKeys = NULL;
+    graph->index = NULL;
+    graph->disk = (Disk *) malloc(sizeof(Disk));
+    if (!graph->disk)
     {
-        graph->processes[i].firstEvent = NULL;
+        free(graph);
+        return NULL;
     }
-    graph->disk = (Disk *) malloc(sizeof(Disk));
     graph->disk->firstEvent = NULL;
+    graph->disk->lastEvent = NULL;
 
     return graph;
 }
@@ -97,119 +117,106 @@ void freeGraph(ProcessGraph *graph)
         }
     }
     free(graph->disk);
+    free(graph->processes);
+    free(graph->indexKeys);
+    free(graph->index);
     free(graph);
 }
 
 void addProcessToGraph(ProcessGraph *graph, int processId)
 {
-    if (graph->nbProcesses >= MAX_PROCESSES)
+    if (!graph)
+    {
+        return;
+    }
+
+    if (graph->nbProcesses == graph->processesCapacity && !growGraphProcesses(graph))
     {
-        fprintf(stderr, "Error: Maximum number of processes reached\n");
+        fprintf(stderr, "Error: Memory allocation failed\n");
         return;
     }
 
+    int slot = getProcessSlot(graph, processId);
+    if (graph->index[slot] != NO_PROCESS)
+    {
+        fprintf(stderr, "Error: Process already in the graph\n");
+        return;
+    }
+    graph->indexKeys[slot] = processId;
+    graph->index[slot] = graph->nbProcesses;
     graph->processes[graph->nbProcesses].processId = processId;
+    graph->processes[graph->nbProcesses].firstEvent = NULL;
+    graph->processes[graph->nbProcesses].lastEvent = NULL;
     graph->nbProcesses++;
 }
 
-void addProcessEventToGraph(ProcessGraph *graph, int processId, int time, ProcessState state, int coreId)
+void addProcessEventToGraph(ProcessGraph *graph, int processId, int64_t time, ProcessState state, int coreId)
 {
-    Event *event = createNewEventForGraph(graph, time);
-    if (!event)
+    if (!graph)
     {
         return;
     }
 
+    char symbol;
     switch (state)
     {
         case RUNNING:
-            event->symbol = idToSymbol(coreId);
+            symbol = idToSymbol(coreId);
             break;
         case WAITING:
-            event->symbol = WAITING_SYMBOL;
+            symbol = WAITING_SYMBOL;
             break;
         case READY:
-            event->symbol = READY_SYMBOL;
+            symbol = READY_SYMBOL;
             break;
         case TERMINATED:
-            event->symbol = TERMINATED_SYMBOL;
+            symbol = TERMINATED_SYMBOL;
             break;
         default:
             fprintf(stderr, "Error: Invalid process state\n");
             return;
     }
 
-    int i = 0;
-    for (i = 0; i < graph->nbProcesses; i++)
-    {
-        if (graph->processes[i].processId == processId)
-        {
-            break;
-        }
-    }
-    if (i >= graph->nbProcesses)
+    int i = graph->nbProcesses > 0 ? graph->index[getProcessSlot(graph, processId)] : NO_PROCESS;
+    if (i == NO_PROCESS)
     {
         fprintf(stderr, "Error: Process not found\n");
         return;
     }
 
-    if (graph->processes[i].firstEvent == NULL)
-    {
-        graph->processes[i].firstEvent = event;
-    }
-    else
-    {
-        Event *currentEvent = graph->processes[i].firstEvent;
-        while (currentEvent->nextEvent != NULL)
-        {
-            currentEvent = currentEvent->nextEvent;
-        }
-        currentEvent->nextEvent = event;
-    }
+    addEventToList(graph, &graph->processes[i].firstEvent, &graph->processes[i].lastEvent, time, symbol);
 }
 
-void addDiskEventToGraph(ProcessGraph *graph, int processId, int time, DiskState state)
+void addDiskEventToGraph(ProcessGraph *graph, int processId, int64_t time, DiskState state)
 {
-    Event *event = createNewEventForGraph(graph, time);
-    if (!event)
+    if (!graph)
     {
         return;
     }
 
+    char symbol;
     switch (state)
     {
         case DISK_RUNNING:
-            event->symbol = idToSymbol(processId);
+            symbol = idToSymbol(processId);
             break;
         case DISK_IDLE:
-            event->symbol = DISK_IDLE_SYMBOL;
+            symbol = DISK_IDLE_SYMBOL;
             break;
         default:
             fprintf(stderr, "Error: Invalid state for disk\n");
             return;
     }
 
-    if (graph->disk->firstEvent == NULL)
-    {
-        graph->disk->firstEvent = event;
-    }
-    else
-    {
-        Event *currentEvent = graph->disk->firstEvent;
-        while (currentEvent->nextEvent != NULL)
-        {
-            currentEvent = currentEvent->nextEvent;
-        }
-        currentEvent->nextEvent = event;
-    }
+    addEventToList(graph, &graph->disk->firstEvent, &graph->disk->lastEvent, time, symbol);
 }
 
 void printGraph(ProcessGraph *graph)
 {
     printf("Process");
-    for (int i = 0; i < graph->nbTimeSlots; i += 5)
+    for (int64_t i = 0; i < graph->nbTimeSlots; i += 5)
     {
-        printf("%5d", i);
+        printf("%5" PRId64, i);
     }
     printf("\n");
 
@@ -226,7 +233,7 @@ void printGraph(ProcessGraph *graph)
         }
 
         // print spaces until the first event
-        int t = 0;
+        int64_t t = 0;
         for (; t < currentEvent->time && t < graph->nbTimeSlots; t++)
         {
             printf(" ");
@@ -255,7 +262,7 @@ void printGraph(ProcessGraph *graph)
     if (currentEvent)
     {
         // print spaces until the first event
-        int t = 0;
+        int64_t t = 0;
         for (; t < currentEvent->time && t < graph->nbTimeSlots; t++)
         {
             printf(" ");
@@ -282,28 +289,84 @@ void printGraph(ProcessGraph *graph)
 
 /* ---------------------------- static functions --------------------------- */
 
-static Event *createNewEventForGraph(ProcessGraph *graph, int time)
+static int getProcessSlot(const ProcessGraph *graph, int processId)
 {
-    if (time >= MAX_TIME_SLOTS)
+    int size = 2 * graph->processesCapacity;
+    unsigned int slot = getHashHome(processId, size);
+    while (graph->index[slot] != NO_PROCESS && graph->indexKeys[slot] != processId)
     {
-        fprintf(stderr, "Error: Maximum number of time slots reached\n");
-        return NULL;
+        slot = (slot + 1) & (unsigned int) (size - 1);
+    }
+    return (int) slot;
+}
+
+static bool growGraphProcesses(ProcessGraph *graph)
+{
+    // twice as large, the index is built again (load factor <= 1/2)
+    int capacity = graph->processesCapacity == 0 ? INITIAL_PROCESSES_CAPACITY : 2 * graph->processesCapacity;
+    Process *processes = (Process *) realloc(graph->processes, capacity * sizeof(Process));
+    if (!processes)
+    {
+        return false;
+    }
+    graph->processes = processes;
+    int *indexKeys = (int *) malloc(2 * capacity * sizeof(int));
+    int *index = (int *) malloc(2 * capacity * sizeof(int));
+    if (!indexKeys || !index)
+    {
+        free(indexKeys);
+        free(index);
+        return false;
     }
+    free(graph->indexKeys);
+    free(graph->index);
+    graph->indexKeys = indexKeys;
+    graph->index = index;
+    graph->processesCapacity = capacity;
 
+    for (int i = 0; i < 2 * capacity; i++)
+    {
+        graph->index[i] = NO_PROCESS;
+    }
+    for (int i = 0; i < graph->nbProcesses; i++)
+    {
+        int slot = getProcessSlot(graph, graph->processes[i].processId);
+        graph->indexKeys[slot] = graph->processes[i].processId;
+        graph->index[slot] = i;
+    }
+    return true;
+}
+
+static void addEventToList(ProcessGraph *graph, Event **firstEvent, Event **lastEvent, int64_t time, char symbol)
+{
     graph->nbTimeSlots = (time + 1 > graph->nbTimeSlots) ? time + 1 : graph->nbTimeSlots;
 
+    // same symbol as before: nothing changes in the graph
+    if (*lastEvent && (*lastEvent)->symbol == symbol)
+    {
+        return;
+    }
+
     Event *event = (Event *) malloc(sizeof(Event));
     if (!event)
     {
         fprintf(stderr, "Error: Memory allocation failed\n");
-        return NULL;
+        return;
     }
 
     event->time = time;
     event->nextEvent = NULL;
-    event->symbol = ' ';
+    event->symbol = symbol;
 
-    return event;
+    if (*lastEvent == NULL)
+    {
+        *firstEvent = event;
+    }
+    else
+    {
+        (*lastEvent)->nextEvent = event;
+    }
+    *lastEvent = event;
 }
 
 static char idToSymbol(int id)
@@ -1,6 +1,8 @@
 #ifndef graph_h
 #define graph_h
 
+#include <stdint.h>
+
 #include "process.h"
 
 #define NO_CORE -1
@@ -13,6 +15,11 @@ typedef enum
 
 typedef struct ProcessGraph_t ProcessGraph;
 
+/*
+ * The functions adding elements to the graph do nothing if the graph is NULL,
+ * which allows to run a simulation without building its graph.
+ */
+
 /**
  * Initialize a new Graph that will be used to display the execution of the processes.
  *
@@ -44,7 +51,7 @@ void addProcessToGraph(ProcessGraph *graph, int processId);
  * @param state: the state of the process
  * @param coreId: the id of the core on which the process is running
  */
-void addProcessEventToGraph(ProcessGraph *graph, int processId, int time, ProcessState state, int coreId);
+void addProcessEventToGraph(ProcessGraph *graph, int processId, int64_t time, ProcessState state, int coreId);
 
 /**
  * Add a disk event (IO) to the graph.
@@ -54,7 +61,7 @@ void addProcessEventToGraph(ProcessGraph *graph, int processId, int time, Proces
  * @param time: the time at which the event occurs
  * @param state: the state of the disk
  */
-void addDiskEventToGraph(ProcessGraph *graph, int processId, int time, DiskState state);
+void addDiskEventToGraph(ProcessGraph *graph, int processId, int64_t time, DiskState state);
 
 /**
  * Print the graph to the console.
@@ -7,6 +7,7 @@
 #include "graph.h"
 #include "stats.h"
 #include "simulation.h"
+#include "sweep.h"
 #include "utils.h"
 #include "schedulingAlgorithms.h"
 
@@ -16,10 +17,101 @@
 static void printHelp(void)
 {
     printf("Usage: ./cpuScheduler INPUT_FILE -c NB_CORES -q NB_READY_QUEUES ALGORITHM_OPTIONS_QUEUE_0 [ALGORITHM_OPTIONS_QUEUE_1] [...]\n");
+    printf("       ./cpuScheduler INPUT_FILE --sweep [--threads=NB_THREADS] -c NB_CORES[,NB_CORES...] SWEEP_LAYOUT [SWEEP_LAYOUT] [...]\n");
     printf("ALGORITHM_OPTIONS: --algorithm=ALGORITHM\n");
     printf("                   [--RRSlice=RRSLICE_LIMIT]\n");
     printf("                   [--limit=TIME_LIMIT]\n");
     printf("                   [--age=AGE_LIMIT]\n");
+    printf("SIMULATION_OPTIONS (anywhere after -q): [--event-driven]\n");
+    printf("                                        [--max-time=SIMULATED_TIME_LIMIT]\n");
+    printf("                                        [--max-wall-time=SECONDS]\n");
+    printf("                                        [--max-stall-time=SIMULATED_TIME_WITHOUT_PROGRESS]\n");
+    printf("                                        [--seed=SEED]\n");
+    printf("                                        [--stream]\n");
+    printf("                                        [--per-core-queues]\n");
+    printf("INPUT_FILE: text input file or binary workload file (see ./convertWorkload)\n");
+    printf("--stream: read the text INPUT_FILE, sorted by start time, during the simulation and only print\n");
+    printf("          the summary of the stats (the memory used does not depend on the length of the file)\n");
+    printf("--per-core-queues: give each core its own ready queues, the idle cores steal processes from\n");
+    printf("                   the busiest core, and print the load balancing counters\n");
+    printf("SWEEP_LAYOUT: -q NB_READY_QUEUES SWEEP_OPTIONS_QUEUE_0 [SWEEP_OPTIONS_QUEUE_1] [...]\n");
+    printf("SWEEP_OPTIONS: ALGORITHM_OPTIONS where each value can be a comma-separated list\n");
+    printf("               (e.g. --algorithm=RR,FCFS --RRSlice=2,4), every combination is simulated\n");
+}
+
+/**
+ * Run the sweep mode: simulate every configuration of the grid given on the
+ * command line on the same workload and print the summary of each.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ *
+ * @return The exit status.
+ */
+static int runSweepMode(int argc, const char *argv[])
+{
+    Sweep *sweep = parseSweepArguments(argc, argv);
+    if (!sweep)
+    {
+        printHelp();
+        return EXIT_FAILURE;
+    }
+
+    Workload *workload = loadWorkload(argv[1]);
+    if (!workload)
+    {
+        freeSweep(sweep);
+        return EXIT_FAILURE;
+    }
+
+    printVerbose("Starting sweep\n");
+    bool success = runSweep(sweep, workload);
+    printVerbose("Sweep finished\n");
+
+    freeSweep(sweep);
+    freeWorkload(workload);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Run the stream mode: simulate the input file while reading it and print the
+ * summary of the stats.
+ *
+ * @param argv The arguments.
+ * @param readyQueueAlgorithms The scheduling algorithms for the ready queues.
+ * @param options The simulation options.
+ *
+ * @return The exit status.
+ */
+static int runStreamMode(const char *argv[], SchedulingAlgorithm **readyQueueAlgorithms, const SimulationOptions *options)
+{
+    AllStats *allStats = initStats();
+    if (!allStats)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printVerbose("Starting streamed simulation\n");
+    bool success = launchStreamedSimulation(argv[1], readyQueueAlgorithms, atoi(argv[5]), atoi(argv[3]), allStats, options);
+    printVerbose("Simulation finished\n");
+
+    if (success)
+    {
+        StatsSummary summary;
+        getStatsSummary(allStats, &summary);
+        printf("----------------- Stats -----------------\n");
+        printStatsSummary(&summary);
+        if (options->perCoreQueues)
+        {
+            printLoadBalanceStats(allStats);
+        }
+        printf("-----------------------------------------\n");
+    }
+
+    freeStats(allStats);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 /**
@@ -27,10 +119,11 @@ static void printHelp(void)
  *
  * @param argc The number of arguments.
  * @param argv The arguments.
+ * @param options The simulation options to fill.
  *
  * @return The scheduling algorithms for the ready queues.
  */
-static SchedulingAlgorithm **parseArguments(int argc, const char* argv[])
+static SchedulingAlgorithm **parseArguments(int argc, const char* argv[], SimulationOptions *options)
 {
     if (argc < 7)
     {
@@ -76,9 +169,23 @@ static SchedulingAlgorithm **parseArguments(int argc, const char* argv[])
     }
 
     // Parse algorithm options
+    setDefaultSimulationOptions(options);
     int queueIndex = 0;
+    bool validOption;
     while (i < argc)
     {
+        if (parseSimulationOption(argv[i], options, &validOption))
+        {
+            if (!validOption)
+            {
+                fprintf(stderr, "Error: Invalid value for option %s\n", argv[i]);
+                printHelp();
+                exit(EXIT_FAILURE);
+            }
+            i++;
+            continue;
+        }
+
         if (queueIndex > nbReadyQueues)
         {
             printf("i: %d\n", i);
@@ -123,17 +230,26 @@ static SchedulingAlgorithm **parseArguments(int argc, const char* argv[])
         i++;
         while (i < argc && strncmp(argv[i], "--algorithm=", 12) != 0)
         {
+            // the timers are checked as the simulation options, and only set if valid
             if (strncmp(argv[i], "--RRSlice=", 10) == 0)
             {
-                readyQueueAlgorithms[queueIndex]->RRSliceLimit = atoi(argv[i] + 10);
+                validOption = parseOptionValue(argv[i] + 10, 1, MAX_LIMIT, &readyQueueAlgorithms[queueIndex]->RRSliceLimit);
             }
             else if (strncmp(argv[i], "--limit=", 8) == 0)
             {
-                readyQueueAlgorithms[queueIndex]->executiontTimeLimit = atoi(argv[i] + 8);
+                validOption = parseOptionValue(argv[i] + 8, 1, MAX_LIMIT, &readyQueueAlgorithms[queueIndex]->executiontTimeLimit);
             }
             else if (strncmp(argv[i], "--age=", 6) == 0)
             {
-                readyQueueAlgorithms[queueIndex]->ageLimit = atoi(argv[i] + 6);
+                validOption = parseOptionValue(argv[i] + 6, 1, MAX_LIMIT, &readyQueueAlgorithms[queueIndex]->ageLimit);
+                if (validOption && queueIndex == 0)
+                {
+                    fprintf(stderr, "Warning: --age has no effect on queue 0, there is no queue before it\n");
+                }
+            }
+            else if (parseSimulationOption(argv[i], options, &validOption))
+            {
+                // not specific to this queue
             }
             else
             {
@@ -141,6 +257,12 @@ static SchedulingAlgorithm **parseArguments(int argc, const char* argv[])
                 printHelp();
                 exit(EXIT_FAILURE);
             }
+            if (!validOption)
+            {
+                fprintf(stderr, "Error: Invalid value for option %s\n", argv[i]);
+                printHelp();
+                exit(EXIT_FAILURE);
+            }
             i++;
         }
 
@@ -162,7 +284,17 @@ static SchedulingAlgorithm **parseArguments(int argc, const char* argv[])
  */
 int main(int argc, const char *argv[])
 {
-    SchedulingAlgorithm **readyQueueAlgorithms = parseArguments(argc, argv);
+    if (argc > 2 && strcmp(argv[2], "--sweep") == 0)
+    {
+        return runSweepMode(argc, argv);
+    }
+
+    SimulationOptions options;
+    SchedulingAlgorithm **readyQueueAlgorithms = parseArguments(argc, argv, &options);
+    if (options.stream)
+    {
+        return runStreamMode(argv, readyQueueAlgorithms, &options);
+    }
 
     ProcessGraph *graph = initGraph();
     if (!graph)
@@ -177,7 +309,7 @@ int main(int argc, const char *argv[])
         return EXIT_FAILURE;
     }
 
-    Workload *workload = parseInputFile(argv[1]);
+    Workload *workload = loadWorkload(argv[1]);
     if (!workload)
     {
         freeGraph(graph);
@@ -186,12 +318,23 @@ int main(int argc, const char *argv[])
     }
 
     printVerbose("Starting simulation\n");
-    launchSimulation(workload, readyQueueAlgorithms, atoi(argv[5]), atoi(argv[3]), graph, allStats);
+    bool success = launchSimulation(workload, readyQueueAlgorithms, atoi(argv[5]), atoi(argv[3]), graph, allStats, &options);
     printVerbose("Simulation finished\n");
+    if (!success)
+    {
+        freeGraph(graph);
+        freeStats(allStats);
+        freeWorkload(workload);
+        return EXIT_FAILURE;
+    }
 
     printVerbose("Printing results\n");
     printf("----------------- Stats -----------------\n");
     printStats(allStats);
+    if (options.perCoreQueues)
+    {
+        printLoadBalanceStats(allStats);
+    }
     printf("-----------------------------------------\n");
     printf("----------------- Graph -----------------\n");
     printGraph(graph);
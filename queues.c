@@ -4,55 +4,118 @@
 
 #include "queues.h"
 
-Node *initNode(PCB *pcb)
+#define INITIAL_HEAP_CAPACITY 16
+
+/* ---------------------------- static functions --------------------------- */
+
+/**
+ * Checks whether a node is dequeued before another one in a heap-ordered queue:
+ * lowest key first, then lowest sequence (order of insertion).
+ *
+ * @param order The order of the queue.
+ * @param node The first node.
+ * @param other The second node.
+ *
+ * @return True if node is dequeued before other.
+ */
+static bool nodeBefore(QueueOrder order, const Node *node, const Node *other);
+
+/**
+ * Place a node at the given hole of the heap, moving it up or down until the
+ * heap order is restored, and update the heap indexes of the moved nodes.
+ *
+ * @param queue The heap-ordered queue.
+ * @param node The node to place.
+ * @param index The index of the hole (its content is overwritten).
+ */
+static void siftHeapNode(Queue *queue, Node *node, int index);
+
+/**
+ * Remove the node at the given index of the heap of the queue.
+ *
+ * @param queue The heap-ordered queue.
+ * @param index The index of the node to remove.
+ */
+static void removeHeapNode(Queue *queue, int index);
+
+/**
+ * Checks whether a node comes before another one in a DeadlineHeap: earliest
+ * deadline first, then lowest deadline sequence (order of insertion).
+ *
+ * @param node The first node.
+ * @param other The second node.
+ *
+ * @return True if node comes before other.
+ */
+static bool deadlineBefore(const Node *node, const Node *other);
+
+/**
+ * Place a node at the given hole of a DeadlineHeap, moving it up or down until
+ * the heap order is restored, and update the indexes of the moved nodes.
+ *
+ * @param heap The heap.
+ * @param node The node to place.
+ * @param index The index of the hole (its content is overwritten).
+ */
+static void siftDeadlineNode(DeadlineHeap *heap, Node *node, int index);
+
+/* ------------------------------ queue functions -------------------------- */
+
+void initNode(Node *node, PCB *pcb)
 {
-    if (!pcb)
-    {
-        return NULL;
-    }
-    Node *node = (Node *)malloc(sizeof(Node));
-    if (!node)
-    {
-        return NULL;
-    }
     node->queueNbr=0;
     node->pcb = pcb;
     node->executionTime = -1; //default value: only used for SJF
     node->currentQueueWaitingTime = 0;
+    node->waitingTime = 0;
+    node->enqueueTime = 0;
     node->currentQueueExecutionTime = 0;
+    node->executionStart = 0;
+    node->sequence = 0;
+    node->heapIndex = -1;
+    node->queue = NULL;
+    node->deadline = 0;
+    node->deadlineSequence = 0;
+    node->deadlineIndex = -1;
+    node->coreIndex = -1;
+    node->lastCoreIndex = -1;
+    node->runQueueIndex = 0;
+    node->runningIndex = -1;
+    node->onDisk = false;
     node->prev = NULL;
     node->next = NULL;
-
-    return node;
 }
 
 Queue *initQueue(void)
+{
+    return initOrderedQueue(QUEUE_FIFO);
+}
+
+Queue *initOrderedQueue(QueueOrder order)
 {
     Queue *queue = (Queue *) malloc(sizeof(Queue));
     if (!queue)
     {
         return NULL;
     }
+    queue->order = order;
     queue->head = NULL;
     queue->tail = NULL;
+    queue->heap = NULL; // allocated at the first enqueue
+    queue->heapCapacity = 0;
+    queue->nextSequence = 0;
     queue->size = 0; //usefull for RR
 
     return queue;
 }
 
-void freeNode(Node *node)
-{
-    free(node);
-}
-
 void freeQueue(Queue *queue)
 {
-    Node *node, *nextNode;
-    for (node = queue->head; node; node = nextNode)
+    if (!queue)
     {
-        nextNode = node->next;
-        freeNode(node);
+        return;
     }
+    free(queue->heap);
     free(queue);
 }
 
@@ -68,6 +131,8 @@ int queueSize(Queue *queue)
 
 void enqueueNodeFCFS(Queue *queue, Node *node)
 {
+    node->queue = queue;
+    node->sequence = queue->nextSequence++;
     node->next = NULL;
 
     if (!queue->head)
@@ -85,146 +150,226 @@ void enqueueNodeFCFS(Queue *queue, Node *node)
     queue->size += 1;
 }
 
-void enqueueNodePriority(Queue *queue, Node *node)
+bool enqueueNode(Queue *queue, Node *node)
 {
-    if (!queue->head)
+    if (queue->order == QUEUE_FIFO)
     {
-        node->next = NULL;
-        node->prev = NULL;
-        queue->head = node;
-        queue->tail = node;
+        enqueueNodeFCFS(queue, node);
+        return true;
     }
-    else
+
+    if (queue->size == queue->heapCapacity)
     {
-        if (node->pcb->priority < queue->head->pcb->priority)
+        int capacity = queue->heapCapacity ? 2 * queue->heapCapacity : INITIAL_HEAP_CAPACITY;
+        Node **heap = (Node **) realloc(queue->heap, capacity * sizeof(Node *));
+        if (!heap)
         {
-            node->prev = NULL;
-            queue->head->prev = node;
-            node->next = queue->head;
-            queue->head = node;
-        }
-        else if (node->pcb->priority >= queue->tail->pcb->priority)
-        {
-            node->next = NULL;
-            queue->tail->next = node;
-            node->prev = queue->tail;
-            queue->tail = node;
-        }
-        else {
-            Node *tmp = queue->head->next;
-            while (node->pcb->priority >= tmp->pcb->priority)
-                tmp = tmp->next;
-            (tmp->prev)->next = node;
-            node->prev = tmp->prev;
-            node->next = tmp;
-            tmp->prev = node;
+            return false;
         }
+        queue->heap = heap;
+        queue->heapCapacity = capacity;
     }
+    node->queue = queue;
+    node->sequence = queue->nextSequence++;
+    node->prev = NULL;
+    node->next = NULL;
     queue->size += 1;
+    siftHeapNode(queue, node, queue->size - 1);
+    return true;
 }
 
-void enqueueNodeSJF(Queue *queue, Node *node)
+Node *dequeueTopNode(Queue *queue)
 {
-    if (!queue->head)
-    {
-        node->next = NULL;
-        node->prev = NULL;
-        queue->head = node;
-        queue->tail = node;
-    }
-    else
+    Node *firstNode = topNode(queue);
+    if (firstNode)
     {
-        if (node->executionTime < queue->head->executionTime)
-        {
-            node->prev = NULL;
-            queue->head->prev = node;
-            node->next = queue->head;
-            queue->head = node;
-        }
-        else if (node->executionTime >= queue->tail->executionTime)
-        {
-            node->next = NULL;
-            queue->tail->next = node;
-            node->prev = queue->tail;
-            queue->tail = node;
-        }
-        else {
-            Node *tmp = queue->head->next;
-            while (node->executionTime >= tmp->executionTime)
-                tmp = tmp->next;
-            (tmp->prev)->next = node;
-            node->prev = tmp->prev;
-            node->next = tmp;
-            tmp->prev = node;
-        }
+        removeNode(queue, firstNode);
     }
-    queue->size += 1;
+
+    return firstNode;
 }
 
-Node *dequeueTopNode(Queue *queue)
+void removeNode(Queue *queue, Node *node)
 {
-    Node *firstNode = queue->head;
-    if (firstNode)
+    if (node->queue != queue)
     {
-        queue->head = firstNode->next;
-        queue->size -= 1;
+        return;
     }
-    if (!queue->head)
+    node->queue = NULL;
+    if (queue->order != QUEUE_FIFO)
     {
-        queue->tail = NULL;
+        removeHeapNode(queue, node->heapIndex);
+        return;
     }
+
+    if (node->prev)
+        node->prev->next = node->next;
     else
+        queue->head = node->next;
+    if (node->next)
+        node->next->prev = node->prev;
+    else
+        queue->tail = node->prev;
+    node->prev = NULL;
+    node->next = NULL;
+    queue->size -= 1;
+}
+
+Node *topNode(Queue *queue)
+{
+    if (queue->order != QUEUE_FIFO)
+        return queue->size ? queue->heap[0] : NULL;
+    return queue->head;
+}
+
+bool nodeInQueue(const Queue *queue, const Node *node)
+{
+    return node->queue == queue;
+}
+
+/* ---------------------------- heap functions ---------------------------- */
+
+static bool nodeBefore(QueueOrder order, const Node *node, const Node *other)
+{
+    int64_t key = order == QUEUE_PRIORITY ? node->pcb->priority : node->executionTime;
+    int64_t otherKey = order == QUEUE_PRIORITY ? other->pcb->priority : other->executionTime;
+    if (key != otherKey)
+        return key < otherKey;
+    return node->sequence < other->sequence;
+}
+
+static void siftHeapNode(Queue *queue, Node *node, int index)
+{
+    Node **heap = queue->heap;
+    // up
+    while (index > 0 && nodeBefore(queue->order, node, heap[(index - 1) / 2]))
     {
-        queue->head->prev = NULL;
+        int parent = (index - 1) / 2;
+        heap[index] = heap[parent];
+        heap[index]->heapIndex = index;
+        index = parent;
+    }
+    // down
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= queue->size)
+            break;
+        if (child + 1 < queue->size && nodeBefore(queue->order, heap[child + 1], heap[child]))
+            child += 1;
+        if (!nodeBefore(queue->order, heap[child], node))
+            break;
+        heap[index] = heap[child];
+        heap[index]->heapIndex = index;
+        index = child;
     }
+    heap[index] = node;
+    node->heapIndex = index;
+}
 
-    return firstNode;
+static void removeHeapNode(Queue *queue, int index)
+{
+    queue->size -= 1;
+    if (index < queue->size)
+        siftHeapNode(queue, queue->heap[queue->size], index);
 }
 
-void removeNode(Queue *queue, Node *node)
+static bool deadlineBefore(const Node *node, const Node *other)
+{
+    if (node->deadline != other->deadline)
+        return node->deadline < other->deadline;
+    return node->deadlineSequence < other->deadlineSequence;
+}
+
+static void siftDeadlineNode(DeadlineHeap *heap, Node *node, int index)
 {
-    Node *tmpNode = queue->head;
-    if (queue->head == node)
+    Node **nodes = heap->nodes;
+    // up
+    while (index > 0 && deadlineBefore(node, nodes[(index - 1) / 2]))
     {
-        queue->head = queue->head->next;
-        if (queue->head)
-            queue->head->prev = NULL;
-        queue->size -= 1;
-        return;
+        int parent = (index - 1) / 2;
+        nodes[index] = nodes[parent];
+        nodes[index]->deadlineIndex = index;
+        index = parent;
+    }
+    // down
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= heap->size)
+            break;
+        if (child + 1 < heap->size && deadlineBefore(nodes[child + 1], nodes[child]))
+            child += 1;
+        if (!deadlineBefore(nodes[child], node))
+            break;
+        nodes[index] = nodes[child];
+        nodes[index]->deadlineIndex = index;
+        index = child;
+    }
+    nodes[index] = node;
+    node->deadlineIndex = index;
+}
+
+/* ------------------------- deadline heap functions ----------------------- */
+
+DeadlineHeap *initDeadlineHeap(void)
+{
+    DeadlineHeap *heap = (DeadlineHeap *) malloc(sizeof(DeadlineHeap));
+    if (!heap)
+    {
+        return NULL;
     }
-    else if (queue->tail == node)
+    heap->nodes = NULL; // allocated at the first push
+    heap->size = 0;
+    heap->capacity = 0;
+    heap->nextSequence = 0;
+
+    return heap;
+}
+
+void freeDeadlineHeap(DeadlineHeap *heap)
+{
+    if (!heap)
     {
-        queue->tail = queue->tail->prev;
-        queue->tail->next = NULL;
-        queue->size -= 1;
         return;
     }
-    while (tmpNode)
+    free(heap->nodes);
+    free(heap);
+}
+
+bool pushDeadlineNode(DeadlineHeap *heap, Node *node)
+{
+    if (heap->size == heap->capacity)
     {
-        if (tmpNode == node)
+        int capacity = heap->capacity ? 2 * heap->capacity : INITIAL_HEAP_CAPACITY;
+        Node **nodes = (Node **) realloc(heap->nodes, capacity * sizeof(Node *));
+        if (!nodes)
         {
-            tmpNode->prev->next = tmpNode->next;
-            tmpNode->next->prev = tmpNode;
-            queue->size -= 1;
-            break;
+            return false;
         }
-        tmpNode = tmpNode->next;
+        heap->nodes = nodes;
+        heap->capacity = capacity;
     }
+    node->deadlineSequence = heap->nextSequence++;
+    heap->size += 1;
+    siftDeadlineNode(heap, node, heap->size - 1);
+    return true;
 }
 
-Node *topNode(Queue *queue)
+void removeDeadlineNode(DeadlineHeap *heap, Node *node)
 {
-    return queue->head;
+    int index = node->deadlineIndex;
+    if (index < 0 || index >= heap->size || heap->nodes[index] != node)
+    {
+        return;
+    }
+    node->deadlineIndex = -1;
+    heap->size -= 1;
+    if (index < heap->size)
+        siftDeadlineNode(heap, heap->nodes[heap->size], index);
 }
 
-bool processInQueue(Queue *queue, int pid)
+Node *topDeadlineNode(DeadlineHeap *heap)
 {
-    Node *node = queue->head;
-    while (node)
-    {
-        if (node->pcb->pid == pid)
-            return true;
-        node = node->next;
-    }
-    return false;
+    return heap->size ? heap->nodes[0] : NULL;
 }
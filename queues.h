@@ -2,6 +2,7 @@
 #define queues_h
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "process.h"
 
 typedef struct Node_t Node;
@@ -9,29 +10,71 @@ struct Node_t
 {
     int queueNbr; //for multilevel: to be able to be put back in the correct queue
     PCB *pcb;
-    int executionTime; // for SJF
-    int currentQueueExecutionTime; // for --limit
-    int currentQueueWaitingTime; //for --age
+    int64_t executionTime; // for SJF
+    int64_t currentQueueExecutionTime; // for --limit, up to the last time the node stopped running
+    int64_t executionStart; // time at which the node last started running on a core
+    int64_t currentQueueWaitingTime; //for --age, up to the last time the node left its ready queue
+    int64_t waitingTime; // time spent in all the ready queues, up to the last time the node left one
+    int64_t enqueueTime; // time at which the node entered its current ready queue
+    int64_t sequence; // order of insertion in the queue: breaks the ties between equal keys
+    int heapIndex; // position in the heap of a heap-ordered queue
+    struct Queue_t *queue; // queue containing the node, NULL if it is in none
+    int64_t deadline; // key of the node in a DeadlineHeap (for --age: time at which it reaches the age limit)
+    int64_t deadlineSequence; // order of insertion in its DeadlineHeap: breaks the ties between equal deadlines
+    int deadlineIndex; // position in its DeadlineHeap, -1 if it is in none
+    int coreIndex; // index of the core holding the node, -1 if it is on none
+    int lastCoreIndex; // index of the last core that held the node, -1 if it never ran
+    int runQueueIndex; // run queue of the ready queues of the node (per-core run queues)
+    int runningIndex; // position in the heap of the running nodes of the run queue of its core, -1 if it is in none
+    bool onDisk; // true while the node is on the disk
     struct Node_t *prev;
     struct Node_t *next;
 };
 
+// Order in which the nodes of a queue are dequeued
+typedef enum
+{
+    QUEUE_FIFO, // doubly-linked list, in the order of insertion (FCFS, RR and the waiting queue)
+    QUEUE_PRIORITY, // binary heap, lowest pcb->priority first (PRIORITY)
+    QUEUE_SHORTEST_JOB, // binary heap, lowest executionTime first (SJF)
+} QueueOrder;
+
 typedef struct Queue_t Queue;
 struct Queue_t
 {
-    Node *head;
-    Node *tail;
+    QueueOrder order;
+    Node *head; // QUEUE_FIFO only
+    Node *tail; // QUEUE_FIFO only
+    Node **heap; // heap-ordered queues only, heap[0] is the top node
+    int heapCapacity;
+    int64_t nextSequence;
+    int size;
+};
+
+/*
+ * The DeadlineHeap struct is a binary min-heap of nodes ordered by their
+ * deadline, then by their order of insertion, to find the next nodes reaching
+ * a deadline without walking all of them. A node can be in a Queue and in a
+ * DeadlineHeap at the same time.
+ */
+typedef struct DeadlineHeap_t DeadlineHeap;
+struct DeadlineHeap_t
+{
+    Node **nodes; // nodes[0] has the earliest deadline
     int size;
+    int capacity;
+    int64_t nextSequence; // deadline sequence of the next node pushed
 };
 
 /**
- * Initializes a new Node with the specified pcb.
+ * Initializes the given Node, out of any queue, with the specified pcb.
+ * Nodes are not allocated by the queues: they are part of the records of the
+ * processes in the simulation state, which owns them.
  *
+ * @param node The node to initialize.
  * @param pcb The pcb of the Node.
- * 
- * @return a pointer to the new Node, or NULL if memory allocation fails.
  */
-Node *initNode(PCB *pcb);
+void initNode(Node *node, PCB *pcb);
 
 /**
  * Initializes an empty Queue.
@@ -41,16 +84,19 @@ Node *initNode(PCB *pcb);
 Queue *initQueue(void);
 
 /**
- * Free the memory allocated for the Node.
- * Note: This does not free the PCB as it was not allocated to create the node
+ * Initializes an empty Queue whose nodes are dequeued in the given order.
+ * The heap-ordered queues have an O(log n) enqueue and an O(1) topNode, the
+ * nodes with equal keys being dequeued in their order of insertion.
  *
- * @param node The node to free
+ * @param order The order of the queue.
+ *
+ * @return a pointer to the new Queue, or NULL if memory allocation fails.
  */
-void freeNode(Node *node);
+Queue *initOrderedQueue(QueueOrder order);
 
 /**
  * Free the memory allocated for the Queue.
- * Note: This does not free the PCBs as they were not allocated to create the queue
+ * Note: This does not free the nodes and their PCBs as they were not allocated by the queue
  *
  * @param queue The queue to free
  */
@@ -83,20 +129,17 @@ int queueSize(Queue *queue);
 void enqueueNodeFCFS(Queue *queue, Node *node);
 
 /**
- * Adds a process node to the given queue according to the prriority.
+ * Adds a process node to the given queue according to the order of the queue
+ * (at the back of a QUEUE_FIFO queue).
+ * For a QUEUE_SHORTEST_JOB queue, the executionTime of the node must be set
+ * before and not change while the node is in the queue.
  *
  * @param queue The queue to which the node will be added.
  * @param node The process node to be added to the queue.
- */
-void enqueueNodePriority(Queue *queue, Node *node);
-
-/**
- * Adds a process node to the given queue accoding to the execution time.
  *
- * @param queue The queue to which the node will be added.
- * @param node The process node to be added to the queue.
+ * @return true on success, false if memory allocation fails.
  */
-void enqueueNodeSJF(Queue *queue, Node *node);
+bool enqueueNode(Queue *queue, Node *node);
 
 /**
  * Dequeue the first process Node from the given queue.
@@ -108,7 +151,8 @@ void enqueueNodeSJF(Queue *queue, Node *node);
 Node *dequeueTopNode(Queue *queue);
 
 /**
- * Dequeue a specific Node from the given queue (if present).
+ * Dequeue a specific Node from the given queue (if present), in O(1) for a
+ * FIFO queue and O(log n) for a heap-ordered one.
  *
  * @param queue The queue from which to dequeue the process node.
  * @param node The process node to dequeue.
@@ -125,13 +169,55 @@ void removeNode(Queue *queue, Node *node);
 Node *topNode(Queue *queue);
 
 /**
- * Checks if a process pid is inside the queue.
+ * Checks if a process node is inside the queue, in O(1).
  *
  * @param queue The queue to check.
- * @param pid The process pid.
+ * @param node The process node.
  * 
- * @return True if the process pid is inside the queue, false otherwise.
+ * @return True if the node is inside the queue, false otherwise.
+ */
+bool nodeInQueue(const Queue *queue, const Node *node);
+
+/**
+ * Initializes an empty DeadlineHeap.
+ *
+ * @return a pointer to the new DeadlineHeap, or NULL if memory allocation fails.
+ */
+DeadlineHeap *initDeadlineHeap(void);
+
+/**
+ * Free the memory allocated for the DeadlineHeap (not the nodes).
+ *
+ * @param heap The heap to free.
+ */
+void freeDeadlineHeap(DeadlineHeap *heap);
+
+/**
+ * Adds a node to the heap, in O(log n). Its deadline must be set before and
+ * not change while the node is in the heap.
+ *
+ * @param heap The heap to which the node will be added.
+ * @param node The node to add.
+ *
+ * @return true on success, false if memory allocation fails.
+ */
+bool pushDeadlineNode(DeadlineHeap *heap, Node *node);
+
+/**
+ * Removes a node from the heap (if present), in O(log n).
+ *
+ * @param heap The heap from which to remove the node.
+ * @param node The node to remove.
+ */
+void removeDeadlineNode(DeadlineHeap *heap, Node *node);
+
+/**
+ * Get the node with the earliest deadline, without removing it.
+ *
+ * @param heap The heap.
+ *
+ * @return The node, or NULL if the heap is empty.
  */
-bool processInQueue(Queue *queue, int pid);
+Node *topDeadlineNode(DeadlineHeap *heap);
 
 #endif // queues_h
\ No newline at end of file
@@ -7,7 +7,7 @@
 
 #include "schedulingAlgorithms.h"
 
-SchedulingAlgorithm *initSchedulingAlgorithm(SchedulingAlgorithmType type, int RRSliceLimit, int executiontTimeLimit, int ageLimit)
+SchedulingAlgorithm *initSchedulingAlgorithm(SchedulingAlgorithmType type, int64_t RRSliceLimit, int64_t executiontTimeLimit, int64_t ageLimit)
 {
     SchedulingAlgorithm *algorithm = (SchedulingAlgorithm *) malloc(sizeof(SchedulingAlgorithm));
     if (!algorithm)
@@ -50,3 +50,20 @@ void setAlgorithmType(SchedulingAlgorithm *algorithm, const char *type)
         exit(EXIT_FAILURE);
     }
 }
+
+const char *getAlgorithmTypeName(SchedulingAlgorithmType type)
+{
+    switch (type)
+    {
+        case RR:
+            return "RR";
+        case FCFS:
+            return "FCFS";
+        case SJF:
+            return "SJF";
+        case PRIORITY:
+            return "PRIORITY";
+        default:
+            return "UNKNOWN";
+    }
+}
@@ -2,8 +2,10 @@
 #define schedulingAlgorithms_h
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #define NO_LIMIT -1
+#define MAX_LIMIT (INT64_MAX / 2) // largest limit of a timer: it is added to a time without overflow
 
 /**
  * @brief Definition of the SchedulingAlgorithm struct.
@@ -25,9 +27,9 @@ struct SchedulingAlgorithm_t
     SchedulingAlgorithmType type;
     
     // NO_LIMIT means there is no limit to the timer -> the timer is not used
-    int RRSliceLimit;
-    int executiontTimeLimit;
-    int ageLimit;
+    int64_t RRSliceLimit;
+    int64_t executiontTimeLimit;
+    int64_t ageLimit;
 };
 
 /**
@@ -40,7 +42,7 @@ struct SchedulingAlgorithm_t
  *
  * @return a pointer to the new SchedulingAlgorithm
  */
-SchedulingAlgorithm *initSchedulingAlgorithm(SchedulingAlgorithmType type, int RRSliceLimit, int executiontTimeLimit, int ageLimit);
+SchedulingAlgorithm *initSchedulingAlgorithm(SchedulingAlgorithmType type, int64_t RRSliceLimit, int64_t executiontTimeLimit, int64_t ageLimit);
 
 /**
  * Free the memory allocated for the SchedulingAlgorithm.
@@ -57,4 +59,13 @@ void freeSchedulingAlgorithm(SchedulingAlgorithm *algorithm);
  */
 void setAlgorithmType(SchedulingAlgorithm *algorithm, const char *type);
 
+/**
+ * Get the name of the given algorithm type, as accepted by setAlgorithmType.
+ *
+ * @param type: the type of the algorithm
+ *
+ * @return the name of the algorithm type (e.g. "RR", "FCFS", "SJF", "PRIORITY")
+ */
+const char *getAlgorithmTypeName(SchedulingAlgorithmType type);
+
 #endif // schedulingAlgorithms_h
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <limits.h>
+#include <string.h>
 
 #include "computer.h"
 #include "schedulingLogic.h"
@@ -13,37 +14,212 @@
 #include "queues.h"
 
 #define NB_WAIT_QUEUES 1
+#define QUEUE_WORD_BITS 64 // ready queues per word of the non-empty queues bitmap
+#define CORE_WORD_BITS 64 // cores per word of the bitmap of the preemption checks
 
 /* --------------------------- struct definitions -------------------------- */
 
+/*
+ * A RunQueue gathers the multilevel ready queues from which the cores take
+ * their processes: the scheduler has a single one shared by all the cores, or
+ * one per core (--per-core-queues).
+ */
+typedef struct RunQueue_t
+{
+    Queue **readyQueues;
+    uint64_t *nonEmptyReadyQueues; //bitmap: bit i % QUEUE_WORD_BITS of word i / QUEUE_WORD_BITS is set if ready queue i is not empty
+    Node **runningNodes; //max-heap of the nodes running on the cores of the run queue, the easiest to preempt first
+    int nbRunningNodes;
+    int size; //number of processes in the ready queues
+    bool coreBusy; //per-core run queues: the core of the run queue holds a process
+} RunQueue;
+
 struct Scheduler_t
 {
     // This is not the ready queues, but the ready queue algorithms
     SchedulingAlgorithm **readyQueueAlgorithms;
     int readyQueueCount;
-    Queue **readyQueues;
+    RunQueue *runQueues; //a single run queue shared by the cores, or one per core
+    int runQueueCount;
+    int coreCount;
+    int nbReadyQueueWords;
+    int nbCoreWords;
+    uint64_t *preemptionChecks; //bitmap: bit i % CORE_WORD_BITS of word i / CORE_WORD_BITS is set if the process of core i must be checked for preemption
+    int nbReadyProcesses; //number of processes in the ready queues of all the run queues
     int waitingQueueCount;
     Queue **waitingQueues;
-    Workload *workload; //usefull for SJF
+    SimulationState *state; //usefull for SJF
     int *queuesSizesBeforeRR; //created heee to avoid many malloc and free
+    int64_t time; //current time, the waiting times are computed from the enqueue times of the nodes
+    DeadlineHeap *agingHeap; //for --age: nodes of the ready queues with an age limit, of all the run queues, by time of promotion (NULL without age limit)
+    LoadBalanceStats loadBalance;
 };
 
 /* ---------------------------- static functions --------------------------- */
 
 /**
- * Update the queue waiting timer
+ * Allocate the ready queues of a run queue, with the algorithms of the scheduler.
+ *
+ * @param scheduler The scheduler.
+ * @param runQueue The run queue, zeroed.
+ *
+ * @return True on success, false if an allocation failed (the run queue must
+ *         still be freed with freeRunQueue).
+ */
+static bool initRunQueue(const Scheduler *scheduler, RunQueue *runQueue);
+
+/**
+ * Free the ready queues of a run queue.
+ *
+ * @param scheduler The scheduler.
+ * @param runQueue The run queue.
+ */
+static void freeRunQueue(const Scheduler *scheduler, RunQueue *runQueue);
+
+/**
+ * Get the run queue from which a core takes its processes.
+ *
+ * @param scheduler The scheduler.
+ * @param coreIndex The index of the core.
+ *
+ * @return The index of the run queue.
+ */
+static int getCoreRunQueue(const Scheduler *scheduler, int coreIndex);
+
+/**
+ * Get the run queue in which a process becoming ready is put: the run queue
+ * of the last core it ran on, for the cache affinity, or the least loaded one
+ * (processes in the ready queues and on the core) if it never ran.
+ *
+ * @param scheduler The scheduler.
+ * @param node The node of the process.
+ *
+ * @return The index of the run queue.
+ */
+static int placeReadyProcess(const Scheduler *scheduler, const Node *node);
+
+/**
+ * Get the run queue with the most processes in its ready queues, to steal one.
+ *
+ * @param scheduler The scheduler.
+ *
+ * @return The index of the run queue, or -1 if all the ready queues are empty.
+ */
+static int busiestRunQueue(const Scheduler *scheduler);
+
+/**
+ * Account the time a node spent in its ready queue when it leaves it, and
+ * remove it from the aging heap of the queue.
+ *
+ * @param scheduler The scheduler.
+ * @param runQueue The run queue of the ready queue.
+ * @param queueNbr The ready queue left by the node.
+ * @param node The node leaving its ready queue.
+ */
+static void leaveReadyQueue(Scheduler *scheduler, RunQueue *runQueue, int queueNbr, Node *node);
+
+/**
+ * Get the time the process of an OCCUPIED core has been executing in its
+ * current ready queue (for --limit), including its current run.
+ *
+ * @param scheduler The scheduler.
+ * @param core The core.
+ *
+ * @return The execution time in the current queue.
+ */
+static int64_t getQueueExecutionTime(const Scheduler *scheduler, const Core *core);
+
+/**
+ * Account the execution time of the process of a core when it stops running
+ * on it (the core leaves the OCCUPIED state).
+ *
+ * @param scheduler The scheduler.
+ * @param core The core.
+ */
+static void stopProcessExecution(Scheduler *scheduler, Core *core);
+
+/**
+ * Remove the process node from a core, which no longer holds it. The node can
+ * already be on another core (put back in the ready queues after an IO burst
+ * during a switch out delayed by an interrupt): it then keeps its new core.
+ *
+ * @param scheduler The scheduler.
+ * @param core The core.
+ * @param coreIndex The index of the core.
+ */
+static void releaseCore(Scheduler *scheduler, Core *core, int coreIndex);
+
+/**
+ * Checks whether the process node of a core still owns it: the process runs on
+ * the core, possibly paused by an interrupt. A process switching out (even
+ * during an interrupt) has already left the core, and can even have finished a
+ * short IO burst meanwhile.
+ *
+ * @param core The core.
  *
- * @param deltaTime The number of step to advance.
- * @param scheduler the scheduler
+ * @return True if the process of the core owns it.
  */
-static void advanceWaitingTime(Scheduler *scheduler, int deltaTime);
+static bool processOwnsCore(const Core *core);
+
+/**
+ * Get the order of a ready queue of the given algorithm: the PRIORITY and SJF
+ * queues are heap-ordered, the FCFS and RR ones are FIFO.
+ *
+ * @param type The scheduling algorithm of the queue.
+ *
+ * @return The order of the queue.
+ */
+static QueueOrder getReadyQueueOrder(SchedulingAlgorithmType type);
+
+/**
+ * Checks whether the processes of a ready queue are promoted to the previous
+ * queue when they reach its age limit (--age).
+ *
+ * @param scheduler The scheduler.
+ * @param queueNbr The ready queue.
+ *
+ * @return True if the ready queue has an age limit and a queue before it.
+ */
+static bool readyQueueAges(const Scheduler *scheduler, int queueNbr);
+
+/**
+ * Handle the aging of the ready queues at the current time: the processes
+ * reaching the age limit of their queue are taken from the aging heap of the
+ * scheduler and moved to the previous queue, in the order of their deadlines,
+ * then of their arrival in their queue. Only these processes are visited.
+ *
+ * @param scheduler The scheduler.
+ *
+ * @return False if a process could not be put in its new queue.
+ */
+static bool promoteAgedProcesses(Scheduler *scheduler);
+
+/**
+ * Update the bit of a ready queue in the bitmap of the non-empty ready queues,
+ * after a node was added to or removed from it.
+ *
+ * @param runQueue The run queue of the ready queue.
+ * @param queueNbr The ready queue.
+ */
+static void updateNonEmptyReadyQueue(RunQueue *runQueue, int queueNbr);
+
+/**
+ * Get the first (highest priority) non-empty ready queue, with a find-first-set
+ * on the bitmap of the non-empty ready queues.
+ *
+ * @param scheduler The scheduler.
+ * @param runQueue The run queue.
+ *
+ * @return The number of the queue, or -1 if all the ready queues are empty.
+ */
+static int firstNonEmptyReadyQueue(const Scheduler *scheduler, const RunQueue *runQueue);
 
 /**
  * Checks whether there is another process in a higher priority ready queue.
  * 
  * @return True if there is another process
 */
-static bool otherProcessInReadyQueue(Scheduler *scheduler, int queueNbr);
+static bool otherProcessInReadyQueue(Scheduler *scheduler, RunQueue *runQueue, int queueNbr);
 
 /**
  * Checks whether there is a process from the same queue that has a higher priority 
@@ -51,7 +227,22 @@ static bool otherProcessInReadyQueue(Scheduler *scheduler, int queueNbr);
  * 
  * @return True if there is a process with a higher priority.
 */
-static bool higherPriorityProcessInReadyQueue(Scheduler *scheduler, int queueNbr, Node *node);
+static bool higherPriorityProcessInReadyQueue(Scheduler *scheduler, RunQueue *runQueue, int queueNbr, Node *node);
+
+/**
+ * Compare the key (execution time or priority) of the top node of a ready
+ * queue with the key of the process running on a core. With per-core ready
+ * queues, a preempted process goes back to the run queue of its core, so a
+ * key only preempts when it is strictly smaller: two processes with the same
+ * key would take the core from each other forever.
+ *
+ * @param scheduler The scheduler.
+ * @param headKey The key of the top node of the ready queue.
+ * @param key The key of the running process.
+ *
+ * @return True if the top node preempts the running process.
+ */
+static bool keyPreempts(const Scheduler *scheduler, int64_t headKey, int64_t key);
 
 /**
  * Checks whether there is a process from a higher priority queue or 
@@ -60,7 +251,113 @@ static bool higherPriorityProcessInReadyQueue(Scheduler *scheduler, int queueNbr
  * 
  * @return True if there is another process
 */
-static bool higherPriorityProcessInReadyQueues(Scheduler *scheduler, int queueNbr, Node *node);
+static bool higherPriorityProcessInReadyQueues(Scheduler *scheduler, RunQueue *runQueue, int queueNbr, Node *node);
+
+/**
+ * Checks whether a process put in a ready queue preempts a running process,
+ * with respect to the ready queues and the scheduling algorithm of their queue.
+ *
+ * @param scheduler The scheduler.
+ * @param queueNbr The ready queue of the process.
+ * @param node The process put in the ready queue.
+ * @param running The running process.
+ *
+ * @return True if the process preempts the running process.
+ */
+static bool nodePreempts(const Scheduler *scheduler, int queueNbr, const Node *node, const Node *running);
+
+/**
+ * Checks whether the process running on a core must be preempted by a higher
+ * priority process of the ready queues of the core. Removing processes from the ready queues
+ * can not make a higher priority process appear: a core is only checked again
+ * if a process that can preempt its process was put in the ready queues, or if
+ * the process on the core changed (see requestPreemptionCheck), since the last
+ * check that did not preempt.
+ *
+ * @param scheduler The scheduler.
+ * @param core The core, in the OCCUPIED state.
+ *
+ * @return True if the process must be preempted, false otherwise.
+ */
+static bool preemptionNeeded(Scheduler *scheduler, Core *core);
+
+/**
+ * Force the next preemption check of a core, after the process on the core
+ * started running or moved to another ready queue, or after a process that can
+ * preempt it was put in the ready queues.
+ *
+ * @param scheduler The scheduler.
+ * @param coreIndex The index of the core.
+ */
+static void requestPreemptionCheck(Scheduler *scheduler, int coreIndex);
+
+/**
+ * Request the preemption check of the cores of a run queue whose process can
+ * be preempted by a process put in one of its ready queues. Only these cores
+ * are visited, through the heap of the running nodes of the run queue.
+ *
+ * @param scheduler The scheduler.
+ * @param runQueue The run queue.
+ * @param queueNbr The ready queue of the process.
+ * @param node The process put in the ready queue.
+ * @param index The index of the subtree of the heap to visit.
+ */
+static void requestPreemptionChecks(Scheduler *scheduler, RunQueue *runQueue, int queueNbr, const Node *node, int index);
+
+/**
+ * Add a node starting to run on its core to the heap of the running nodes of
+ * the run queue of the core, and request the preemption check of the core.
+ *
+ * @param scheduler The scheduler.
+ * @param node The node, with the index of its core.
+ */
+static void addRunningNode(Scheduler *scheduler, Node *node);
+
+/**
+ * Remove a node from the heap of the running nodes of the run queue of its
+ * core (if present).
+ *
+ * @param scheduler The scheduler.
+ * @param node The node, with the index of its core.
+ */
+static void removeRunningNode(Scheduler *scheduler, Node *node);
+
+/**
+ * Checks whether a running node is easier to preempt than another one: it
+ * runs from a later ready queue or, in the same preemptive ready queue, has a
+ * greater key (execution time or priority).
+ *
+ * @param scheduler The scheduler.
+ * @param node The first node.
+ * @param other The second node.
+ *
+ * @return True if the first node is easier to preempt.
+ */
+static bool runningNodeBefore(const Scheduler *scheduler, const Node *node, const Node *other);
+
+/**
+ * Place a node at the given hole of the heap of the running nodes of a run
+ * queue, moving it up or down until the heap order is restored, and update
+ * the indexes of the moved nodes.
+ *
+ * @param scheduler The scheduler.
+ * @param runQueue The run queue.
+ * @param node The node to place.
+ * @param index The index of the hole (its content is overwritten).
+ */
+static void siftRunningNode(const Scheduler *scheduler, RunQueue *runQueue, Node *node, int index);
+
+/**
+ * Returns the earliest time between nextTime and the time at which a counter,
+ * that advances with the time, reaches its limit.
+ *
+ * @param nextTime The earliest event time found so far.
+ * @param time The current time.
+ * @param timeLeft The time left before the counter reaches its limit.
+ *
+ * @return The earliest of the two times.
+ */
+static int64_t earliestEventTime(int64_t nextTime, int64_t time, int64_t timeLeft);
 
 /* -------------------------- getters and setters -------------------------- */
 
@@ -69,47 +366,73 @@ int getWaitQueueCount(void)
     return NB_WAIT_QUEUES;
 }
 
+int64_t getSchedulerTime(const Scheduler *scheduler)
+{
+    return scheduler->time;
+}
+
+const LoadBalanceStats *getLoadBalanceStats(const Scheduler *scheduler)
+{
+    return &scheduler->loadBalance;
+}
+
 /* -------------------------- init/free functions -------------------------- */
 
-Scheduler *initScheduler(SchedulingAlgorithm **readyQueueAlgorithms, int readyQueueCount, Workload *workload)
+Scheduler *initScheduler(SchedulingAlgorithm **readyQueueAlgorithms, int readyQueueCount, int coreCount, bool perCoreQueues, SimulationState *state)
 {
     Scheduler *scheduler = malloc(sizeof(Scheduler));
     if (!scheduler)
     {
+        //the algorithms are owned by the scheduler, as when freeScheduler is called below
+        for (int i = 0; i < readyQueueCount; i++)
+        {
+            freeSchedulingAlgorithm(readyQueueAlgorithms[i]);
+        }
+        free(readyQueueAlgorithms);
         return NULL;
     }
 
     scheduler->readyQueueAlgorithms = readyQueueAlgorithms;
     scheduler->readyQueueCount = readyQueueCount;
-    scheduler->readyQueues = (Queue **) malloc(readyQueueCount * sizeof(Queue *));
-    for (int i=0; i<readyQueueCount; i++)
+    scheduler->nbReadyQueueWords = (readyQueueCount + QUEUE_WORD_BITS - 1) / QUEUE_WORD_BITS;
+    scheduler->nbReadyProcesses = 0;
+    scheduler->coreCount = coreCount;
+    scheduler->nbCoreWords = (coreCount + CORE_WORD_BITS - 1) / CORE_WORD_BITS;
+    scheduler->preemptionChecks = (uint64_t *) calloc(scheduler->nbCoreWords, sizeof(uint64_t));
+    scheduler->runQueueCount = perCoreQueues ? coreCount : 1;
+    scheduler->runQueues = (RunQueue *) calloc(scheduler->runQueueCount, sizeof(RunQueue));
+    bool allocated = scheduler->runQueues != NULL && scheduler->preemptionChecks != NULL;
+    for (int i = 0; allocated && i < scheduler->runQueueCount; i++)
     {
-        scheduler->readyQueues[i] = initQueue();
+        allocated = initRunQueue(scheduler, &scheduler->runQueues[i]);
     }
     scheduler->waitingQueueCount = getWaitQueueCount();
     scheduler->waitingQueues = (Queue **) malloc(scheduler->waitingQueueCount * sizeof(Queue *));
-    for (int i=0; i<scheduler->waitingQueueCount; i++)
+    for (int i=0; scheduler->waitingQueues && i<scheduler->waitingQueueCount; i++)
     {
         scheduler->waitingQueues[i] = initQueue();
+        allocated = allocated && scheduler->waitingQueues[i];
     }
-    scheduler->workload = workload;
-
-    scheduler->queuesSizesBeforeRR = (int *) malloc(readyQueueCount * sizeof(int));
-    if (!scheduler->queuesSizesBeforeRR)
+    scheduler->state = state;
+    scheduler->time = 0;
+    scheduler->agingHeap = NULL;
+    for (int i = 0; i < readyQueueCount; i++)
     {
-        for (int i = 0; i < scheduler->readyQueueCount; i++)
-        {
-            freeSchedulingAlgorithm(scheduler->readyQueueAlgorithms[i]);
-            freeQueue(scheduler->readyQueues[i]);
-        }
-        for (int i = 0; i < scheduler->waitingQueueCount; i++)
+        if (readyQueueAges(scheduler, i))
         {
-            freeQueue(scheduler->waitingQueues[i]);
+            scheduler->agingHeap = initDeadlineHeap();
+            allocated = allocated && scheduler->agingHeap;
+            break;
         }
-        free(scheduler->readyQueueAlgorithms);
-        free(scheduler->readyQueues);
-        free(scheduler->waitingQueues);
-        free(scheduler);
+    }
+    scheduler->loadBalance.nbStealAttempts = 0;
+    scheduler->loadBalance.nbSteals = 0;
+    scheduler->loadBalance.nbMigrations = 0;
+
+    scheduler->queuesSizesBeforeRR = (int *) malloc(readyQueueCount * sizeof(int));
+    if (!allocated || !scheduler->waitingQueues || !scheduler->queuesSizesBeforeRR)
+    {
+        freeScheduler(scheduler);
         return NULL;
     }
 
@@ -121,231 +444,338 @@ void freeScheduler(Scheduler *scheduler)
     for (int i = 0; i < scheduler->readyQueueCount; i++)
     {
         freeSchedulingAlgorithm(scheduler->readyQueueAlgorithms[i]);
-        freeQueue(scheduler->readyQueues[i]);
     }
-    for (int i = 0; i < scheduler->waitingQueueCount; i++)
+    for (int i = 0; scheduler->runQueues && i < scheduler->runQueueCount; i++)
+    {
+        freeRunQueue(scheduler, &scheduler->runQueues[i]);
+    }
+    for (int i = 0; scheduler->waitingQueues && i < scheduler->waitingQueueCount; i++)
     {
         freeQueue(scheduler->waitingQueues[i]);
     }
     free(scheduler->readyQueueAlgorithms);
-    free(scheduler->readyQueues);
+    free(scheduler->runQueues);
+    free(scheduler->preemptionChecks);
     free(scheduler->waitingQueues);
     free(scheduler->queuesSizesBeforeRR);
+    freeDeadlineHeap(scheduler->agingHeap);
     free(scheduler);
 }
 
 /* -------------------------- scheduling functions ------------------------- */
 
-void putprocessInQueue(Scheduler *scheduler, int queueNbr, Node *node)
+bool putprocessInQueue(Scheduler *scheduler, int queueNbr, Node *node)
 {
-    switch (scheduler->readyQueueAlgorithms[queueNbr]->type)
+    RunQueue *runQueue = &scheduler->runQueues[node->runQueueIndex];
+    if (scheduler->readyQueueAlgorithms[queueNbr]->type == SJF)
+        node->executionTime = getProcessCurEventTimeLeft(scheduler->state, node->pcb->pid);
+    node->enqueueTime = scheduler->time;
+    bool ages = readyQueueAges(scheduler, queueNbr);
+    if (ages)
     {
-        case FCFS:
-            enqueueNodeFCFS(scheduler->readyQueues[queueNbr], node);
-            break;
-        case SJF:
-            node->executionTime = getProcessCurEventTimeLeft(scheduler->workload, node->pcb->pid);
-            enqueueNodeSJF(scheduler->readyQueues[queueNbr], node);
-            break;
-        case RR:
-            enqueueNodeFCFS(scheduler->readyQueues[queueNbr], node);
-            break;
-        case PRIORITY:
-            enqueueNodePriority(scheduler->readyQueues[queueNbr], node);
-            break;
+        //the waiting time in the queue grows with the time while the node stays in it
+        node->deadline = scheduler->time + scheduler->readyQueueAlgorithms[queueNbr]->ageLimit - node->currentQueueWaitingTime;
+        if (!pushDeadlineNode(scheduler->agingHeap, node))
+        {
+            fprintf(stderr, "Error: could not allocate memory for the aging of ready queue %d\n", queueNbr);
+            return false;
+        }
     }
-}
-
-Node *topReadyQueue(Scheduler *scheduler)
-{
-    for (int i=0; i <= scheduler->readyQueueCount; i++)
+    if (!enqueueNode(runQueue->readyQueues[queueNbr], node))
     {
-        if (!isEmptyQueue(scheduler->readyQueues[i]))
-            return topNode(scheduler->readyQueues[i]);
+        fprintf(stderr, "Error: could not allocate memory for ready queue %d\n", queueNbr);
+        if (ages)
+            removeDeadlineNode(scheduler->agingHeap, node);
+        return false;
     }
-    return NULL;
+    //the counters and the bitmap only count the nodes actually in the queue
+    updateNonEmptyReadyQueue(runQueue, queueNbr);
+    requestPreemptionChecks(scheduler, runQueue, queueNbr, node, 0);
+    runQueue->size++;
+    scheduler->nbReadyProcesses++;
+    return true;
 }
 
-Node *dequeueTopReadyQueue(Scheduler *scheduler)
+Node *dequeueTopReadyQueue(Scheduler *scheduler, int runQueueIndex)
 {
     //"Queue 0 is the queue which has the highest priority, then the queue 1, and so on."
-    for (int i=0; i < scheduler->readyQueueCount; i++)
+    RunQueue *runQueue = &scheduler->runQueues[runQueueIndex];
+    int queueNbr = firstNonEmptyReadyQueue(scheduler, runQueue);
+    if (queueNbr < 0)
+        return NULL;
+    Node *node = dequeueTopNode(runQueue->readyQueues[queueNbr]);
+    leaveReadyQueue(scheduler, runQueue, queueNbr, node);
+    return node;
+}
+
+void removeReadyQueueNode(Scheduler *scheduler, int queueNbr, Node *node)
+{
+    RunQueue *runQueue = &scheduler->runQueues[node->runQueueIndex];
+    if (nodeInQueue(runQueue->readyQueues[queueNbr], node))
     {
-        if (!isEmptyQueue(scheduler->readyQueues[i]))
-            return dequeueTopNode(scheduler->readyQueues[i]);
+        removeNode(runQueue->readyQueues[queueNbr], node);
+        leaveReadyQueue(scheduler, runQueue, queueNbr, node);
     }
-    return NULL;
 }
 
-void removeReadyQueueNode(Scheduler *scheduler, int queueNbr, Node *node)
+int64_t getProcessWaitingTime(Scheduler *scheduler, const Node *node)
 {
-    removeNode(scheduler->readyQueues[queueNbr], node);
+    if (nodeInReadyQueues(scheduler, node))
+        return node->waitingTime + scheduler->time - node->enqueueTime;
+    return node->waitingTime;
 }
 
-bool processInReadyQueues(Scheduler *scheduler, int pid)
+bool nodeInReadyQueues(Scheduler *scheduler, const Node *node)
 {
-    for (int i=0; i < scheduler->readyQueueCount; i++)
-    {
-        if (processInQueue(scheduler->readyQueues[i], pid))
-            return 1;
-    }
-    return 0;
+    //a node can only be in the ready queue of its queueNbr, in its run queue
+    return node->queueNbr >= 0 && node->queueNbr < scheduler->readyQueueCount
+        && nodeInQueue(scheduler->runQueues[node->runQueueIndex].readyQueues[node->queueNbr], node);
 }
 
-static bool otherProcessInReadyQueue(Scheduler *scheduler, int queueNbr)
+static bool otherProcessInReadyQueue(Scheduler *scheduler, RunQueue *runQueue, int queueNbr)
 {
-    for (int i=0; i <= queueNbr; i++)
-    {
-        if (!isEmptyQueue(scheduler->readyQueues[i]))
-            return true;
-    }
-    return false;
+    int firstQueueNbr = firstNonEmptyReadyQueue(scheduler, runQueue);
+    return firstQueueNbr >= 0 && firstQueueNbr <= queueNbr;
 }
 
-static bool higherPriorityProcessInReadyQueue(Scheduler *scheduler, int queueNbr, Node *node)
+static bool higherPriorityProcessInReadyQueue(Scheduler *scheduler, RunQueue *runQueue, int queueNbr, Node *node)
 {
+    Node *head = topNode(runQueue->readyQueues[queueNbr]);
+    return head && nodePreempts(scheduler, queueNbr, head, node);
+}
+
+static bool nodePreempts(const Scheduler *scheduler, int queueNbr, const Node *node, const Node *running)
+{
+    if (queueNbr != running->queueNbr)
+        return queueNbr < running->queueNbr;
     //only SJF and PRIORITY are preemptive
-    Node *head;
     switch (scheduler->readyQueueAlgorithms[queueNbr]->type)
     {
-        case FCFS:
-        case RR:
-            break;
         case SJF:
-            head = topNode(scheduler->readyQueues[queueNbr]);
-            if (head && head->executionTime <= node->executionTime)
-                return true;
-            break;
+            return keyPreempts(scheduler, node->executionTime, running->executionTime);
         case PRIORITY:
-            head = topNode(scheduler->readyQueues[queueNbr]);
-            if (head && head->pcb->priority <= node->pcb->priority)
-                return true;
-            break;
+            return keyPreempts(scheduler, node->pcb->priority, running->pcb->priority);
+        default:
+            return false;
     }
+}
+
+static bool keyPreempts(const Scheduler *scheduler, int64_t headKey, int64_t key)
+{
+    if (scheduler->runQueueCount > 1)
+        return headKey < key;
+    return headKey <= key;
+}
+
+static bool higherPriorityProcessInReadyQueues(Scheduler *scheduler, RunQueue *runQueue, int queueNbr, Node *node)
+{
+    return otherProcessInReadyQueue(scheduler, runQueue, queueNbr-1) || higherPriorityProcessInReadyQueue(scheduler, runQueue, queueNbr, node);
+}
+
+static bool preemptionNeeded(Scheduler *scheduler, Core *core)
+{
+    int coreIndex = core->processNode->coreIndex;
+    uint64_t bit = (uint64_t) 1 << (coreIndex % CORE_WORD_BITS);
+    if (!(scheduler->preemptionChecks[coreIndex / CORE_WORD_BITS] & bit))
+        return false;
+    RunQueue *runQueue = &scheduler->runQueues[getCoreRunQueue(scheduler, coreIndex)];
+    if (higherPriorityProcessInReadyQueues(scheduler, runQueue, core->processNode->queueNbr, core->processNode))
+        return true;
+    scheduler->preemptionChecks[coreIndex / CORE_WORD_BITS] &= ~bit;
     return false;
 }
 
-static bool higherPriorityProcessInReadyQueues(Scheduler *scheduler, int queueNbr, Node *node)
+static void requestPreemptionCheck(Scheduler *scheduler, int coreIndex)
+{
+    scheduler->preemptionChecks[coreIndex / CORE_WORD_BITS] |= (uint64_t) 1 << (coreIndex % CORE_WORD_BITS);
+}
+
+static void requestPreemptionChecks(Scheduler *scheduler, RunQueue *runQueue, int queueNbr, const Node *node, int index)
+{
+    //the nodes below a node that is not preempted are harder to preempt: the subtree is skipped
+    if (index >= runQueue->nbRunningNodes || !nodePreempts(scheduler, queueNbr, node, runQueue->runningNodes[index]))
+        return;
+    requestPreemptionCheck(scheduler, runQueue->runningNodes[index]->coreIndex);
+    requestPreemptionChecks(scheduler, runQueue, queueNbr, node, 2 * index + 1);
+    requestPreemptionChecks(scheduler, runQueue, queueNbr, node, 2 * index + 2);
+}
+
+static void addRunningNode(Scheduler *scheduler, Node *node)
+{
+    RunQueue *runQueue = &scheduler->runQueues[getCoreRunQueue(scheduler, node->coreIndex)];
+    //a run queue has a running node per core using it (the heap is allocated for all of them)
+    runQueue->nbRunningNodes++;
+    siftRunningNode(scheduler, runQueue, node, runQueue->nbRunningNodes - 1);
+    requestPreemptionCheck(scheduler, node->coreIndex);
+}
+
+static void removeRunningNode(Scheduler *scheduler, Node *node)
+{
+    if (node->runningIndex < 0)
+        return;
+    RunQueue *runQueue = &scheduler->runQueues[getCoreRunQueue(scheduler, node->coreIndex)];
+    int index = node->runningIndex;
+    node->runningIndex = -1;
+    runQueue->nbRunningNodes--;
+    if (index < runQueue->nbRunningNodes)
+        siftRunningNode(scheduler, runQueue, runQueue->runningNodes[runQueue->nbRunningNodes], index);
+}
+
+static bool runningNodeBefore(const Scheduler *scheduler, const Node *node, const Node *other)
 {
-    return otherProcessInReadyQueue(scheduler, queueNbr-1) || higherPriorityProcessInReadyQueue(scheduler, queueNbr, node);
+    if (node->queueNbr != other->queueNbr)
+        return node->queueNbr > other->queueNbr;
+    switch (scheduler->readyQueueAlgorithms[node->queueNbr]->type)
+    {
+        case SJF:
+            return node->executionTime > other->executionTime;
+        case PRIORITY:
+            return node->pcb->priority > other->pcb->priority;
+        default:
+            return false;
+    }
 }
 
-void handleSchedulerEvents(Computer *computer, int time, AllStats *stats)
+static void siftRunningNode(const Scheduler *scheduler, RunQueue *runQueue, Node *node, int index)
+{
+    Node **heap = runQueue->runningNodes;
+    // up
+    while (index > 0 && runningNodeBefore(scheduler, node, heap[(index - 1) / 2]))
+    {
+        int parent = (index - 1) / 2;
+        heap[index] = heap[parent];
+        heap[index]->runningIndex = index;
+        index = parent;
+    }
+    // down
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= runQueue->nbRunningNodes)
+            break;
+        if (child + 1 < runQueue->nbRunningNodes && runningNodeBefore(scheduler, heap[child + 1], heap[child]))
+            child += 1;
+        if (!runningNodeBefore(scheduler, heap[child], node))
+            break;
+        heap[index] = heap[child];
+        heap[index]->runningIndex = index;
+        index = child;
+    }
+    heap[index] = node;
+    node->runningIndex = index;
+}
+
+bool handleSchedulerEvents(Computer *computer, int64_t time, AllStats *stats)
 {
     //1. Handle event(s): simulator and the scheduler check if an event is triggered at the current time unit and handle it
     //Ex: event = scheduling events, such as a process needing to move to an upper queue because of aging
-    for (int i=0; i < computer->scheduler->readyQueueCount; i++)
+    //To avoid starvation, a process that has been waiting for a certain amount of time in the current queue will be moved to the previous queue (the --age argument).
+    if (computer->scheduler->agingHeap && !promoteAgedProcesses(computer->scheduler))
     {
-        //To avoid starvation, a process that has been waiting for a certain amount of time in the current queue will be moved to the previous queue (the --age argument).
-        if (computer->scheduler->readyQueueAlgorithms[i]->ageLimit != NO_LIMIT)
-        {
-            Node *node = computer->scheduler->readyQueues[i]->head;
-            while (node)
-            {
-                if (node->currentQueueWaitingTime == computer->scheduler->readyQueueAlgorithms[i]->ageLimit)
-                {
-                    //change queue
-                    removeReadyQueueNode(computer->scheduler, node->queueNbr, node);
-                    node->currentQueueExecutionTime = 0;
-                    node->currentQueueWaitingTime = 0;
-                    //"However, whether the context switch should be omitted or not when a process moves from one ready queue to another is not specified in the statement. Therefore, you can choose to omit the context switch in this situation or not"
-                    node->queueNbr -= 1;
-                    handleProcessForCPU(computer->scheduler, node);
-                }
-                node = node->next;
-            }
-        }
+        return false;
     }
     //cpu: switch-in/out
-    for (int i = 0; i < computer->cpu->coreCount; i++)
+    //only the busy cores are visited, in order, through the bitmaps of their states: an idle core holds no process
+    for (int i = firstBusyCore(computer->cpu); i >= 0; i = nextBusyCore(computer->cpu, i))
     {
-        if (computer->cpu->cores[i]->processNode) //if there is a process on the core
+        if (computer->cpu->cores[i].processNode) //if there is a process on the core
         {
-            int pid = computer->cpu->cores[i]->processNode->pcb->pid;
-            if (computer->cpu->cores[i]->state == SWITCH_IN && computer->cpu->cores[i]->switchInTimer == 0)
+            int pid = computer->cpu->cores[i].processNode->pcb->pid;
+            if (computer->cpu->cores[i].state == SWITCH_IN && computer->cpu->cores[i].switchEnd == time)
             {
-                computer->cpu->cores[i]->state = OCCUPIED;
-                computer->cpu->cores[i]->processNode->pcb->state = RUNNING;
+                setCoreState(computer->cpu, i, OCCUPIED);
+                computer->cpu->cores[i].processNode->pcb->state = RUNNING;
+                addRunningNode(computer->scheduler, computer->cpu->cores[i].processNode);
                 /*If on the other hand, a process is preempted by another process at the middle of its time slice,
                 when the process is put back on the CPU, it will start a new time slice from 0.*/
-                computer->cpu->cores[i]->quantumTime = 0;
+                computer->cpu->cores[i].sliceStart = time;
+                computer->cpu->cores[i].processNode->executionStart = time;
             }
-            else if (computer->cpu->cores[i]->state == SWITCH_OUT && computer->cpu->cores[i]->switchOutTimer == 0)
+            else if (computer->cpu->cores[i].state == SWITCH_OUT && computer->cpu->cores[i].switchEnd == time)
             {
-                Node *processNode = computer->cpu->cores[i]->processNode;
-                computer->cpu->cores[i]->state = IDLE;
-                computer->cpu->cores[i]->processNode = NULL; //release the core
-                if (computer->cpu->cores[i]->continueOnCPU)
+                Node *processNode = computer->cpu->cores[i].processNode;
+                setCoreState(computer->cpu, i, IDLE);
+                releaseCore(computer->scheduler, &computer->cpu->cores[i], i); //release the core
+                if (computer->cpu->cores[i].continueOnCPU && !handleProcessForCPU(computer->scheduler, processNode))
                 {
-                    handleProcessForCPU(computer->scheduler, processNode);
+                    return false;
                 }
             }
-            else if (getProcessCurEventTimeLeft(computer->scheduler->workload, computer->cpu->cores[i]->processNode->pcb->pid) == 0) //terminated
+            //also checked when the switch in ends: a process whose last burst is IO has no CPU time left
+            if (processOwnsCore(&computer->cpu->cores[i]) && getProcessCurEventTimeLeft(computer->scheduler->state, computer->cpu->cores[i].processNode->pcb->pid) == 0) //terminated
             {
                 //start switch out/terminated
-                bool terminated = (getProcessAdvancementTime(computer->scheduler->workload, pid) == getProcessDuration(computer->scheduler->workload, pid));
+                bool terminated = (getProcessAdvancementTime(computer->scheduler->state, pid) == getProcessDuration(getSimulationWorkload(computer->scheduler->state), pid));
                 if (terminated)
                 {
                     //terminated: process can "disappear"
                     //"When a process has finished its execution, there is no switch out time."
-                    computer->cpu->cores[i]->processNode->pcb->state = TERMINATED;
-                    computer->cpu->cores[i]->state = IDLE; //release the core
+                    Node *processNode = computer->cpu->cores[i].processNode;
+                    computer->cpu->cores[i].processNode->pcb->state = TERMINATED;
+                    setCoreState(computer->cpu, i, IDLE); //release the core
                     //"The process is simply removed from the core."
-                    freeNode(computer->cpu->cores[i]->processNode);
-                    computer->cpu->cores[i]->processNode = NULL; //release the core
+                    releaseCore(computer->scheduler, &computer->cpu->cores[i], i); //release the core (the node belongs to the simulation state)
 
                     //compute the stats for terminated here to avoid repeating it every time step
                     getProcessStats(stats, pid)->finishTime = time;
                     getProcessStats(stats, pid)->turnaroundTime = time - getProcessStats(stats, pid)->arrivalTime; //finish-arrival
+                    getProcessStats(stats, pid)->waitingTime = processNode->waitingTime;
                     getProcessStats(stats, pid)->meanResponseTime = (double)getProcessStats(stats, pid)->waitingTime/(getProcessStats(stats, pid)->nbContextSwitches+1);
                 }
                 else {
                     //start switch out
-                    Node *processNode = computer->cpu->cores[i]->processNode;
+                    Node *processNode = computer->cpu->cores[i].processNode;
+                    stopProcessExecution(computer->scheduler, &computer->cpu->cores[i]);
                     if (SWITCH_OUT_DURATION > 0)
                     {
-                        computer->cpu->cores[i]->state = SWITCH_OUT;
-                        computer->cpu->cores[i]->switchOutTimer = SWITCH_OUT_DURATION; // start timer
+                        setCoreState(computer->cpu, i, SWITCH_OUT);
+                        computer->cpu->cores[i].switchEnd = time + SWITCH_OUT_DURATION; // start timer
                     } else {
-                        computer->cpu->cores[i]->state = IDLE;
-                        computer->cpu->cores[i]->processNode = NULL; //release the core
+                        setCoreState(computer->cpu, i, IDLE);
+                        releaseCore(computer->scheduler, &computer->cpu->cores[i], i); //release the core
                     }
                     //"An I/O operation can start without having to wait for the process that initiated it to be switched out. Therefore, you must put the process on the wait queue directly (at the same time as the context switch starts)"
                     //The list of events will alternate between CPU and I/O events => next event is a IO_BURST
                     processNode->pcb->state = WAITING;
-                    computer->cpu->cores[i]->continueOnCPU = false;
+                    computer->cpu->cores[i].continueOnCPU = false;
                     handleProcessForDisk(computer->scheduler, processNode);
                     getProcessStats(stats, pid)->nbContextSwitches += 1;
                 }
             }
 
-            if (computer->cpu->cores[i]->state == OCCUPIED)
+            if (computer->cpu->cores[i].state == OCCUPIED)
             {
                 //For a process to move to the next queue, it must have been executing in the current queue for a certain amount of time (the --limit argument).
-                int queueNbr = computer->cpu->cores[i]->processNode->queueNbr;
+                int queueNbr = computer->cpu->cores[i].processNode->queueNbr;
                 if (computer->scheduler->readyQueueAlgorithms[queueNbr]->executiontTimeLimit != NO_LIMIT)
                 {
-                    if (computer->cpu->cores[i]->processNode->currentQueueExecutionTime == computer->scheduler->readyQueueAlgorithms[queueNbr]->executiontTimeLimit)
+                    if (getQueueExecutionTime(computer->scheduler, &computer->cpu->cores[i]) == computer->scheduler->readyQueueAlgorithms[queueNbr]->executiontTimeLimit)
                     {
                         //change queue
                         //what to do when it is not the end of the slice
-                        computer->cpu->cores[i]->processNode->currentQueueExecutionTime = 0;
-                        computer->cpu->cores[i]->processNode->currentQueueWaitingTime = 0;
+                        computer->cpu->cores[i].processNode->currentQueueExecutionTime = 0;
+                        computer->cpu->cores[i].processNode->executionStart = time;
+                        computer->cpu->cores[i].processNode->currentQueueWaitingTime = 0;
                         //"However, whether the context switch should be omitted or not when a process moves from one ready queue to another is not specified in the statement. Therefore, you can choose to omit the context switch in this situation or not"
-                        computer->cpu->cores[i]->processNode->queueNbr += 1;
-                        if (otherProcessInReadyQueue(computer->scheduler, computer->cpu->cores[i]->processNode->queueNbr))
+                        //the node moves in the heap of the running nodes with its ready queue
+                        removeRunningNode(computer->scheduler, computer->cpu->cores[i].processNode);
+                        computer->cpu->cores[i].processNode->queueNbr += 1;
+                        addRunningNode(computer->scheduler, computer->cpu->cores[i].processNode);
+                        RunQueue *runQueue = &computer->scheduler->runQueues[getCoreRunQueue(computer->scheduler, i)];
+                        if (otherProcessInReadyQueue(computer->scheduler, runQueue, computer->cpu->cores[i].processNode->queueNbr))
                         {
                             //start switch out
-                            Node *processNode = computer->cpu->cores[i]->processNode;
+                            Node *processNode = computer->cpu->cores[i].processNode;
                             if (SWITCH_OUT_DURATION > 0)
                             {
-                                computer->cpu->cores[i]->state = SWITCH_OUT;
-                                computer->cpu->cores[i]->switchOutTimer = SWITCH_OUT_DURATION; // start timer
-                                computer->cpu->cores[i]->continueOnCPU = true; //flag to indicate that once the switch-out finished it must go back on the CPU
+                                setCoreState(computer->cpu, i, SWITCH_OUT);
+                                computer->cpu->cores[i].switchEnd = time + SWITCH_OUT_DURATION; // start timer
+                                computer->cpu->cores[i].continueOnCPU = true; //flag to indicate that once the switch-out finished it must go back on the CPU
                             } else {
-                                computer->cpu->cores[i]->state = IDLE;
-                                computer->cpu->cores[i]->processNode = NULL; //release the core
-                                handleProcessForCPU(computer->scheduler, processNode);
+                                setCoreState(computer->cpu, i, IDLE);
+                                releaseCore(computer->scheduler, &computer->cpu->cores[i], i); //release the core
+                                if (!handleProcessForCPU(computer->scheduler, processNode))
+                                    return false;
                             }
                             processNode->pcb->state = READY;
                             getProcessStats(stats, processNode->pcb->pid)->nbContextSwitches += 1;
@@ -353,61 +783,67 @@ void handleSchedulerEvents(Computer *computer, int time, AllStats *stats)
                     }
                 }
             }
-            if (computer->cpu->cores[i]->state == OCCUPIED)
+            if (computer->cpu->cores[i].state == OCCUPIED)
             {
                 //multilevel :
                 /*Supposing there is only one core, a running process should be preempted whenever a higher priority process is ready to run,
                 or when the running process has used up its time slice (in the context of the Round-Robin algorithm).
                 A higher priority process can either be a process from a higher priority queue
                 or a process from the same queue that has a higher priority with respect to the scheduling algorithm of this queue.*/
-                if (computer->cpu->cores[i]->processNode && higherPriorityProcessInReadyQueues(computer->scheduler, computer->cpu->cores[i]->processNode->queueNbr, computer->cpu->cores[i]->processNode))
+                if (computer->cpu->cores[i].processNode && preemptionNeeded(computer->scheduler, &computer->cpu->cores[i]))
                 {
                     //start switch out
-                    Node *processNode = computer->cpu->cores[i]->processNode;
+                    Node *processNode = computer->cpu->cores[i].processNode;
+                    stopProcessExecution(computer->scheduler, &computer->cpu->cores[i]);
                     if (SWITCH_OUT_DURATION > 0)
                     {
-                        computer->cpu->cores[i]->state = SWITCH_OUT;
-                        computer->cpu->cores[i]->switchOutTimer = SWITCH_OUT_DURATION; // start timer
-                        computer->cpu->cores[i]->continueOnCPU = true; //flag to indicate that once the switch-out finished it must go back on the CPU
+                        setCoreState(computer->cpu, i, SWITCH_OUT);
+                        computer->cpu->cores[i].switchEnd = time + SWITCH_OUT_DURATION; // start timer
+                        computer->cpu->cores[i].continueOnCPU = true; //flag to indicate that once the switch-out finished it must go back on the CPU
                     } else
                     {
-                        computer->cpu->cores[i]->state = IDLE;
-                        computer->cpu->cores[i]->processNode = NULL; //release the core
-                        handleProcessForCPU(computer->scheduler, processNode);
+                        setCoreState(computer->cpu, i, IDLE);
+                        releaseCore(computer->scheduler, &computer->cpu->cores[i], i); //release the core
+                        if (!handleProcessForCPU(computer->scheduler, processNode))
+                            return false;
                     }
                     processNode->pcb->state = READY;
                     getProcessStats(stats, processNode->pcb->pid)->nbContextSwitches += 1;
                 }
             }
         }
-        if (computer->cpu->cores[i]->state == INTERRUPTED && computer->cpu->cores[i]->interruptTimer == 0)
+        if (computer->cpu->cores[i].state == INTERRUPTED && computer->cpu->cores[i].interruptEnd == time)
         {
             //the process that was waiting for the IO operation to complete will be put back on the ready queue.
             computer->disk->processNode->pcb->state = READY;
-            advanceNextEvent(computer->scheduler->workload, computer->disk->processNode->pcb->pid); //schedulingLogic should not use the workload, but here thee is no other choice, we need to update the next event
-            handleProcessForCPU(computer->scheduler, computer->disk->processNode);
+            advanceNextEvent(computer->scheduler->state, computer->disk->processNode->pcb->pid); //schedulingLogic should not use the workload, but here thee is no other choice, we need to update the next event
+            if (!handleProcessForCPU(computer->scheduler, computer->disk->processNode))
+                return false;
 
+            computer->disk->processNode->onDisk = false;
             computer->disk->processNode = NULL;
             // need to come back to previous state in the CPU core
-            if (computer->cpu->cores[i]->processNode)
+            if (computer->cpu->cores[i].processNode)
             { //there was a process on the core
-                if (computer->cpu->cores[i]->switchInTimer != 0)
-                {
-                    computer->cpu->cores[i]->state = SWITCH_IN;
-                }
-                else if (computer->cpu->cores[i]->switchOutTimer != 0)
+                //the timers of the core were stopped during the interrupt
+                int64_t interruptDuration = time - computer->cpu->cores[i].interruptStart;
+                if (computer->cpu->cores[i].interruptedState == SWITCH_IN || computer->cpu->cores[i].interruptedState == SWITCH_OUT)
                 {
-                    computer->cpu->cores[i]->state = SWITCH_OUT;
+                    setCoreState(computer->cpu, i, computer->cpu->cores[i].interruptedState);
+                    computer->cpu->cores[i].switchEnd += interruptDuration;
                 }
                 else
                 {
-                    computer->cpu->cores[i]->state = OCCUPIED;
-                    computer->cpu->cores[i]->processNode->pcb->state = RUNNING; //"restart" the process execution
+                    setCoreState(computer->cpu, i, OCCUPIED);
+                    requestPreemptionCheck(computer->scheduler, i);
+                    computer->cpu->cores[i].sliceStart += interruptDuration;
+                    computer->cpu->cores[i].processNode->executionStart += interruptDuration;
+                    computer->cpu->cores[i].processNode->pcb->state = RUNNING; //"restart" the process execution
                 }
             }
             else
             {
-                computer->cpu->cores[i]->state = IDLE;
+                setCoreState(computer->cpu, i, IDLE);
             }
         }
     }
@@ -416,86 +852,109 @@ void handleSchedulerEvents(Computer *computer, int time, AllStats *stats)
     //This is requires to know how many switches will be necessary
     //in addition we must not switch out for process wiating that have a core that is being switch out for them
     //This is to respect the graph for the question on ecampus "multilevel feedback and multicore"
-    int numberSwitchOutCores = 0;
-    for (int i = 0; i < computer->cpu->coreCount; i++)
-        if (computer->cpu->cores[i]->state == SWITCH_OUT)
-            numberSwitchOutCores++;
-    for (int i=0; i < computer->scheduler->readyQueueCount; i++)
-    {
-        computer->scheduler->queuesSizesBeforeRR[i] = queueSize(computer->scheduler->readyQueues[i]);
-        if (numberSwitchOutCores > 0)
+    //(with per-core run queues, only the core of a run queue takes its processes: the sizes are not needed)
+    int numberSwitchOutCores = countCoresInState(computer->cpu, SWITCH_OUT);
+    RunQueue *sharedRunQueue = &computer->scheduler->runQueues[0];
+    //only the non-empty queues are visited, in order, through the bitmap
+    memset(computer->scheduler->queuesSizesBeforeRR, 0, computer->scheduler->readyQueueCount * sizeof(int));
+    for (int word = 0; computer->scheduler->runQueueCount == 1 && word < computer->scheduler->nbReadyQueueWords; word++)
+    {
+        for (uint64_t bits = sharedRunQueue->nonEmptyReadyQueues[word]; bits; bits &= bits - 1)
         {
-            int tmp = min(computer->scheduler->queuesSizesBeforeRR[i], numberSwitchOutCores);
-            computer->scheduler->queuesSizesBeforeRR[i] -= tmp;
-            numberSwitchOutCores -= tmp;
+            int i = word * QUEUE_WORD_BITS + findFirstSet64(bits);
+            computer->scheduler->queuesSizesBeforeRR[i] = queueSize(sharedRunQueue->readyQueues[i]);
+            if (numberSwitchOutCores > 0)
+            {
+                int tmp = min(computer->scheduler->queuesSizesBeforeRR[i], numberSwitchOutCores);
+                computer->scheduler->queuesSizesBeforeRR[i] -= tmp;
+                numberSwitchOutCores -= tmp;
+            }
         }
     }
-    for (int i = computer->cpu->coreCount-1; i >= 0; i--)
+    //only the occupied cores are visited, from the last one, through the bitmap of their state
+    for (int i = lastCoreInState(computer->cpu, OCCUPIED); i >= 0; i = prevCoreInState(computer->cpu, OCCUPIED, i))
     {
-        if (computer->cpu->cores[i]->state == OCCUPIED && computer->cpu->cores[i]->processNode
-        && computer->scheduler->readyQueueAlgorithms[computer->cpu->cores[i]->processNode->queueNbr]->type == RR
-                && computer->scheduler->readyQueueAlgorithms[computer->cpu->cores[i]->processNode->queueNbr]->RRSliceLimit == computer->cpu->cores[i]->quantumTime) //if there is a process on the core
+        if (computer->cpu->cores[i].processNode
+        && computer->scheduler->readyQueueAlgorithms[computer->cpu->cores[i].processNode->queueNbr]->type == RR
+                && computer->scheduler->readyQueueAlgorithms[computer->cpu->cores[i].processNode->queueNbr]->RRSliceLimit == time - computer->cpu->cores[i].sliceStart) //if there is a process on the core
         {
-            if (computer->scheduler->queuesSizesBeforeRR[computer->cpu->cores[i]->processNode->queueNbr])
+            int queueNbr = computer->cpu->cores[i].processNode->queueNbr;
+            bool otherProcessWaiting = computer->scheduler->runQueueCount == 1 ? computer->scheduler->queuesSizesBeforeRR[queueNbr] > 0
+                : !isEmptyQueue(computer->scheduler->runQueues[getCoreRunQueue(computer->scheduler, i)].readyQueues[queueNbr]);
+            if (otherProcessWaiting)
             {
                 //start switch out
-                Node *processNode = computer->cpu->cores[i]->processNode;
+                Node *processNode = computer->cpu->cores[i].processNode;
+                stopProcessExecution(computer->scheduler, &computer->cpu->cores[i]);
                 if (SWITCH_OUT_DURATION > 0)
                 {
-                    computer->cpu->cores[i]->state = SWITCH_OUT;
-                    computer->cpu->cores[i]->switchOutTimer = SWITCH_OUT_DURATION; // start timer
-                    computer->cpu->cores[i]->continueOnCPU = true; //flag to indicate that once the switch-out finished it must go back on the CPU
+                    setCoreState(computer->cpu, i, SWITCH_OUT);
+                    computer->cpu->cores[i].switchEnd = time + SWITCH_OUT_DURATION; // start timer
+                    computer->cpu->cores[i].continueOnCPU = true; //flag to indicate that once the switch-out finished it must go back on the CPU
                 } else {
-                    computer->cpu->cores[i]->state = IDLE;
-                    computer->cpu->cores[i]->processNode = NULL; //release the core
-                    handleProcessForCPU(computer->scheduler, processNode);
+                    setCoreState(computer->cpu, i, IDLE);
+                    releaseCore(computer->scheduler, &computer->cpu->cores[i], i); //release the core
+                    if (!handleProcessForCPU(computer->scheduler, processNode))
+                        return false;
                 }
                 processNode->pcb->state = READY;
-                computer->scheduler->queuesSizesBeforeRR[processNode->queueNbr]--;
+                computer->scheduler->queuesSizesBeforeRR[queueNbr]--;
                 getProcessStats(stats, processNode->pcb->pid)->nbContextSwitches += 1;
             }
             else
             {
                 /*Concerning the RR algorithm, if a process has finished its time slice but no other process is ready
                 to be executed, the process will start a new time slice without passing through the ready queue.*/
-                computer->cpu->cores[i]->quantumTime = 0;
+                computer->cpu->cores[i].sliceStart = time;
             }
         }
     }
+    return true;
 }
 
-void handleProcessForCPU(Scheduler *scheduler, Node *node)
+bool handleProcessForCPU(Scheduler *scheduler, Node *node)
 {
+    node->runQueueIndex = placeReadyProcess(scheduler, node);
     //"In our simulator, every process starts on queue 0"
-    putprocessInQueue(scheduler, node->queueNbr, node);
+    return putprocessInQueue(scheduler, node->queueNbr, node);
 }
 
 void handleProcessForDisk(Scheduler *scheduler, Node *node)
 {
-    advanceNextEvent(scheduler->workload, node->pcb->pid); //schedulingLogic should not use the workload, but here there is no other choice, we need to update the next event
+    advanceNextEvent(scheduler->state, node->pcb->pid); //schedulingLogic should not use the workload, but here there is no other choice, we need to update the next event
     enqueueNodeFCFS(scheduler->waitingQueues[0], node);
 }
 
 void assignProcessesToResources(Computer *computer)
 {
-    bool interrupt = false;
+    Scheduler *scheduler = computer->scheduler;
     //The scheduler will check if a process is ready to be executed and will choose what core it should put it on (or not).
     //here no notion of fairness between cores, always the first cores that get assigned first: could improve that
-    for (int i = 0; i < computer->cpu->coreCount; i++)
+    //only the idle cores are visited, in order, through the bitmap of their state
+    for (int i = firstCoreInState(computer->cpu, IDLE); i >= 0; i = nextCoreInState(computer->cpu, IDLE, i))
     {
-        if (computer->cpu->cores[i]->state == IDLE)
-        {
-            Node *node = dequeueTopReadyQueue(computer->scheduler);
-            if (node)
-            {
-                putProcessOnCPU(computer, i, node);
-            }
-        }
-        if (computer->cpu->cores[i]->state == INTERRUPTED)
+        Node *node = dequeueTopReadyQueue(scheduler, getCoreRunQueue(scheduler, i));
+        if (node)
+            putProcessOnCPU(computer, i, node);
+        else if (scheduler->runQueueCount == 1)
+            break; //the shared run queue is empty for the next idle cores too
+    }
+    //per-core run queues: the cores still idle have an empty run queue, they steal the first
+    //process of the busiest run queue (the first idle cores can take all the processes: the next
+    //ones do not look for one, which would not count as an attempt)
+    if (scheduler->runQueueCount > 1)
+    {
+        for (int i = firstCoreInState(computer->cpu, IDLE); i >= 0 && scheduler->nbReadyProcesses > 0; i = nextCoreInState(computer->cpu, IDLE, i))
         {
-            interrupt = true;
+            scheduler->loadBalance.nbStealAttempts++;
+            int victim = busiestRunQueue(scheduler);
+            if (victim < 0)
+                continue;
+            scheduler->loadBalance.nbSteals++;
+            putProcessOnCPU(computer, i, dequeueTopReadyQueue(scheduler, victim));
         }
     }
+    bool interrupt = firstCoreInState(computer->cpu, INTERRUPTED) >= 0;
     //"Once the interrupt handler completes, the scheduler is informed of the I/O operation's completion, allowing it to schedule the next I/O operation, if applicable"
     //The scheduler could also put a process on the disk if it is idle. (+ no interrupt happening)
     if (!interrupt && computer->disk->state == DISK_IDLE)
@@ -513,18 +972,27 @@ void putProcessOnCPU(Computer *computer, int coreIndex, Node *node)
     //"Whenever a process starts executing on a core, there is a switch in time"
     if (SWITCH_IN_DURATION > 0)
     {
-        computer->cpu->cores[coreIndex]->state = SWITCH_IN;
-        computer->cpu->cores[coreIndex]->switchInTimer = SWITCH_IN_DURATION; // start timer
+        setCoreState(computer->cpu, coreIndex, SWITCH_IN);
+        computer->cpu->cores[coreIndex].switchEnd = computer->scheduler->time + SWITCH_IN_DURATION; // start timer
         node->pcb->state = READY;
     } else
     {
-        computer->cpu->cores[coreIndex]->state = OCCUPIED;
+        setCoreState(computer->cpu, coreIndex, OCCUPIED);
         node->pcb->state = RUNNING;
         /*If on the other hand, a process is preempted by another process at the middle of its time slice,
         when the process is put back on the CPU, it will start a new time slice from 0.*/
-        computer->cpu->cores[coreIndex]->quantumTime = 0;
+        computer->cpu->cores[coreIndex].sliceStart = computer->scheduler->time;
+        node->executionStart = computer->scheduler->time;
     }
-    computer->cpu->cores[coreIndex]->processNode = node;
+    computer->cpu->cores[coreIndex].processNode = node;
+    node->coreIndex = coreIndex;
+    if (computer->cpu->cores[coreIndex].state == OCCUPIED)
+        addRunningNode(computer->scheduler, node);
+    if (node->lastCoreIndex >= 0 && node->lastCoreIndex != coreIndex)
+        computer->scheduler->loadBalance.nbMigrations++;
+    node->lastCoreIndex = coreIndex;
+    if (computer->scheduler->runQueueCount > 1)
+        computer->scheduler->runQueues[getCoreRunQueue(computer->scheduler, coreIndex)].coreBusy = true;
 }
 
 void putProcessOnDisk(Computer *computer, Node *node)
@@ -532,43 +1000,247 @@ void putProcessOnDisk(Computer *computer, Node *node)
     computer->disk->state = DISK_RUNNING;
     node->pcb->state = WAITING;
     computer->disk->processNode = node;
+    node->onDisk = true;
 }
 
-void advanceSchedulingTime(int time, int nextTime, Computer *computer)
+void advanceSchedulingTime(int64_t time, int64_t nextTime, Computer *computer)
 {
-    int deltaTime = nextTime - time;
-    advanceWaitingTime(computer->scheduler, deltaTime);
-    for (int i = 0; i < computer->cpu->coreCount; i++)
+    (void) time;
+    //the timers of the cores and the waiting times of the nodes are not advanced:
+    //they are computed from the current time
+    computer->scheduler->time = nextTime;
+}
+
+static int64_t getQueueExecutionTime(const Scheduler *scheduler, const Core *core)
+{
+    return core->processNode->currentQueueExecutionTime + scheduler->time - core->processNode->executionStart;
+}
+
+static void stopProcessExecution(Scheduler *scheduler, Core *core)
+{
+    if (core->state == OCCUPIED)
+        core->processNode->currentQueueExecutionTime = getQueueExecutionTime(scheduler, core);
+    //the node can be put back in the ready queues before the end of the switch out
+    removeRunningNode(scheduler, core->processNode);
+}
+
+static void releaseCore(Scheduler *scheduler, Core *core, int coreIndex)
+{
+    if (scheduler->runQueueCount > 1)
+        scheduler->runQueues[getCoreRunQueue(scheduler, coreIndex)].coreBusy = false;
+    if (core->processNode->coreIndex == coreIndex)
     {
-        if (computer->cpu->cores[i]->state == OCCUPIED)
-        {
-            computer->cpu->cores[i]->processNode->currentQueueExecutionTime += deltaTime;
-            computer->cpu->cores[i]->quantumTime += deltaTime;
-        }
-        else if (computer->cpu->cores[i]->state == SWITCH_IN)
-        {
-            computer->cpu->cores[i]->switchInTimer -= deltaTime;
-        }
-        else if (computer->cpu->cores[i]->state == SWITCH_OUT)
-        {
-            computer->cpu->cores[i]->switchOutTimer -= deltaTime;
-        }
-        else if (computer->cpu->cores[i]->state == INTERRUPTED)
+        removeRunningNode(scheduler, core->processNode);
+        core->processNode->coreIndex = -1;
+    }
+    core->processNode = NULL;
+}
+
+static bool processOwnsCore(const Core *core)
+{
+    return core->state == OCCUPIED || (core->state == INTERRUPTED && core->interruptedState == OCCUPIED);
+}
+
+static bool initRunQueue(const Scheduler *scheduler, RunQueue *runQueue)
+{
+    runQueue->readyQueues = (Queue **) calloc(scheduler->readyQueueCount, sizeof(Queue *));
+    runQueue->nonEmptyReadyQueues = (uint64_t *) calloc(scheduler->nbReadyQueueWords, sizeof(uint64_t));
+    //the shared run queue is used by all the cores, a per-core one by its core
+    runQueue->runningNodes = (Node **) malloc((scheduler->runQueueCount == 1 ? scheduler->coreCount : 1) * sizeof(Node *));
+    runQueue->nbRunningNodes = 0;
+    runQueue->size = 0;
+    runQueue->coreBusy = false;
+    if (!runQueue->readyQueues || !runQueue->nonEmptyReadyQueues || !runQueue->runningNodes)
+        return false;
+    for (int i=0; i<scheduler->readyQueueCount; i++)
+    {
+        runQueue->readyQueues[i] = initOrderedQueue(getReadyQueueOrder(scheduler->readyQueueAlgorithms[i]->type));
+        if (!runQueue->readyQueues[i])
+            return false;
+    }
+    return true;
+}
+
+static void freeRunQueue(const Scheduler *scheduler, RunQueue *runQueue)
+{
+    for (int i = 0; runQueue->readyQueues && i < scheduler->readyQueueCount; i++)
+        freeQueue(runQueue->readyQueues[i]);
+    free(runQueue->readyQueues);
+    free(runQueue->nonEmptyReadyQueues);
+    free(runQueue->runningNodes);
+}
+
+static int getCoreRunQueue(const Scheduler *scheduler, int coreIndex)
+{
+    return scheduler->runQueueCount == 1 ? 0 : coreIndex;
+}
+
+static int placeReadyProcess(const Scheduler *scheduler, const Node *node)
+{
+    if (scheduler->runQueueCount == 1)
+        return 0;
+    if (node->lastCoreIndex >= 0)
+        return getCoreRunQueue(scheduler, node->lastCoreIndex);
+    int leastLoaded = 0;
+    int leastLoad = INT_MAX;
+    for (int i = 0; i < scheduler->runQueueCount; i++)
+    {
+        int load = scheduler->runQueues[i].size + scheduler->runQueues[i].coreBusy;
+        if (load < leastLoad)
         {
-            computer->cpu->cores[i]->interruptTimer -= deltaTime;
+            leastLoaded = i;
+            leastLoad = load;
         }
     }
+    return leastLoaded;
 }
 
-static void advanceWaitingTime(Scheduler *scheduler, int deltaTime)
+static int busiestRunQueue(const Scheduler *scheduler)
 {
-    for (int i=0; i<scheduler->readyQueueCount; i++)
+    if (scheduler->nbReadyProcesses == 0)
+        return -1;
+    int busiest = 0;
+    for (int i = 1; i < scheduler->runQueueCount; i++)
     {
-        Node *node = scheduler->readyQueues[i]->head;
-        while (node)
+        if (scheduler->runQueues[i].size > scheduler->runQueues[busiest].size)
+            busiest = i;
+    }
+    return busiest;
+}
+
+static void updateNonEmptyReadyQueue(RunQueue *runQueue, int queueNbr)
+{
+    uint64_t bit = (uint64_t) 1 << (queueNbr % QUEUE_WORD_BITS);
+    if (isEmptyQueue(runQueue->readyQueues[queueNbr]))
+        runQueue->nonEmptyReadyQueues[queueNbr / QUEUE_WORD_BITS] &= ~bit;
+    else
+        runQueue->nonEmptyReadyQueues[queueNbr / QUEUE_WORD_BITS] |= bit;
+}
+
+static int firstNonEmptyReadyQueue(const Scheduler *scheduler, const RunQueue *runQueue)
+{
+    //a single word up to QUEUE_WORD_BITS queues, 3 for 140 priority levels
+    for (int i = 0; i < scheduler->nbReadyQueueWords; i++)
+    {
+        if (runQueue->nonEmptyReadyQueues[i])
+            return i * QUEUE_WORD_BITS + findFirstSet64(runQueue->nonEmptyReadyQueues[i]);
+    }
+    return -1;
+}
+
+static QueueOrder getReadyQueueOrder(SchedulingAlgorithmType type)
+{
+    switch (type)
+    {
+        case SJF:
+            return QUEUE_SHORTEST_JOB;
+        case PRIORITY:
+            return QUEUE_PRIORITY;
+        default:
+            return QUEUE_FIFO;
+    }
+}
+
+static bool readyQueueAges(const Scheduler *scheduler, int queueNbr)
+{
+    //there is no queue before the first one to promote the processes to (warned when parsing --age)
+    return queueNbr > 0 && scheduler->readyQueueAlgorithms[queueNbr]->ageLimit != NO_LIMIT;
+}
+
+static bool promoteAgedProcesses(Scheduler *scheduler)
+{
+    Node *node;
+    while ((node = topDeadlineNode(scheduler->agingHeap)) && node->deadline <= scheduler->time)
+    {
+        removeDeadlineNode(scheduler->agingHeap, node);
+        //the waiting time is only checked for equality: a limit already passed is never reached
+        if (node->deadline < scheduler->time)
+            continue;
+        //change queue
+        removeReadyQueueNode(scheduler, node->queueNbr, node);
+        node->currentQueueExecutionTime = 0;
+        node->currentQueueWaitingTime = 0;
+        //"However, whether the context switch should be omitted or not when a process moves from one ready queue to another is not specified in the statement. Therefore, you can choose to omit the context switch in this situation or not"
+        node->queueNbr -= 1;
+        //the node stays in the same run queue
+        if (!putprocessInQueue(scheduler, node->queueNbr, node))
+            return false;
+    }
+    return true;
+}
+
+static void leaveReadyQueue(Scheduler *scheduler, RunQueue *runQueue, int queueNbr, Node *node)
+{
+    int64_t stay = scheduler->time - node->enqueueTime;
+    node->currentQueueWaitingTime += stay;
+    node->waitingTime += stay;
+    if (readyQueueAges(scheduler, queueNbr))
+        removeDeadlineNode(scheduler->agingHeap, node);
+    updateNonEmptyReadyQueue(runQueue, queueNbr);
+    runQueue->size--;
+    scheduler->nbReadyProcesses--;
+}
+
+int64_t getNextSchedulingEventTime(Computer *computer, int64_t time)
+{
+    int64_t nextTime = INT64_MAX;
+    //--age: the next node of the ready queues reaching the age limit
+    if (computer->scheduler->agingHeap)
+    {
+        //the promotions of the current time are done: the nodes whose deadline is passed will never be promoted
+        Node *node;
+        while ((node = topDeadlineNode(computer->scheduler->agingHeap)) && node->deadline <= time)
+            removeDeadlineNode(computer->scheduler->agingHeap, node);
+        if (node)
+            nextTime = min64(nextTime, node->deadline);
+    }
+    //only the busy cores are visited, through the bitmaps of their states: an idle core has no timer
+    for (int i = firstBusyCore(computer->cpu); i >= 0; i = nextBusyCore(computer->cpu, i))
+    {
+        Core *core = &computer->cpu->cores[i];
+        switch (core->state)
+        {
+            case SWITCH_IN:
+                nextTime = earliestEventTime(nextTime, time, core->switchEnd - time);
+                break;
+            case SWITCH_OUT:
+                nextTime = earliestEventTime(nextTime, time, core->switchEnd - time);
+                break;
+            case INTERRUPTED:
+                nextTime = earliestEventTime(nextTime, time, core->interruptEnd - time);
+                break;
+            case OCCUPIED:
+            {
+                SchedulingAlgorithm *algorithm = computer->scheduler->readyQueueAlgorithms[core->processNode->queueNbr];
+                if (algorithm->executiontTimeLimit != NO_LIMIT)
+                    nextTime = earliestEventTime(nextTime, time, algorithm->executiontTimeLimit - getQueueExecutionTime(computer->scheduler, core));
+                if (algorithm->type == RR)
+                    nextTime = earliestEventTime(nextTime, time, algorithm->RRSliceLimit - (time - core->sliceStart));
+                //a process can be put in the ready queues after the preemption check of this core
+                if (preemptionNeeded(computer->scheduler, core))
+                    nextTime = min64(nextTime, time + 1);
+                break;
+            }
+            case IDLE:
+                break;
+        }
+        if (core->processNode)
         {
-            node->currentQueueWaitingTime+=deltaTime;
-            node = node->next;
+            //end of the current burst: a burst already over is handled on the next time unit
+            int64_t timeLeft = getProcessCurEventTimeLeft(computer->scheduler->state, core->processNode->pcb->pid);
+            if (timeLeft > 0)
+                nextTime = earliestEventTime(nextTime, time, timeLeft);
+            else if (timeLeft == 0)
+                nextTime = min64(nextTime, time + 1);
         }
     }
-}
\ No newline at end of file
+    return nextTime;
+}
+
+static int64_t earliestEventTime(int64_t nextTime, int64_t time, int64_t timeLeft)
+{
+    //the timers are only checked for equality: a limit already passed is never reached
+    if (timeLeft <= 0)
+        return nextTime;
+    return min64(nextTime, time + timeLeft);
+}
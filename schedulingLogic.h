@@ -2,6 +2,7 @@
 #define schedulingLogic_h
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "graph.h"
 #include "stats.h"
@@ -22,17 +23,41 @@ typedef struct Scheduler_t Scheduler;
 
 int getWaitQueueCount(void);
 
+/**
+ * Get the current time of the scheduler, used as the origin of the timers.
+ *
+ * @param scheduler The scheduler.
+ *
+ * @return The current time.
+ */
+int64_t getSchedulerTime(const Scheduler *scheduler);
+
+/**
+ * Get the load balancing counters of the scheduler (steals between the run
+ * queues of the cores and migrations of the processes between the cores).
+ *
+ * @param scheduler The scheduler.
+ *
+ * @return The counters.
+ */
+const LoadBalanceStats *getLoadBalanceStats(const Scheduler *scheduler);
+
 /* -------------------------- init/free functions -------------------------- */
 
 /**
- * Initializes a scheduler with the given ready queue algorithms.
+ * Initializes a scheduler with the given ready queue algorithms. The scheduler
+ * owns the algorithms and their array: they are freed with it, or right away
+ * if it can not be initialized.
  *
  * @param readyQueueAlgorithms An array of pointers to SchedulingAlgorithm objects representing the ready queue algorithms.
  * @param readyQueueCount The number of ready queue algorithms in the array.
- * @param workload The workload: necessary in case of SJF.
- * @return A pointer to the initialized Scheduler object.
+ * @param coreCount The number of cores of the CPU.
+ * @param perCoreQueues True to give each core its own ready queues, false to share
+ *                      a single set of ready queues between the cores.
+ * @param state The state of the simulation: necessary in case of SJF.
+ * @return A pointer to the initialized Scheduler object, or NULL on allocation failure.
  */
-Scheduler *initScheduler(SchedulingAlgorithm **readyQueueAlgorithms, int readyQueueCount, Workload *workload);
+Scheduler *initScheduler(SchedulingAlgorithm **readyQueueAlgorithms, int readyQueueCount, int coreCount, bool perCoreQueues, SimulationState *state);
 
 
 /**
@@ -46,31 +71,27 @@ void freeScheduler(Scheduler *scheduler);
 /* -------------------------- scheduling functions ------------------------- */
 
 /**
- * Adds a process to the given queue number queueNbr.
+ * Adds a process to the given queue number queueNbr of its run queue
+ * (runQueueIndex of the node).
  *
  * @param scheduler The Scheduler object where the queues are.
  * @param queueNbr The index of the queue.
  * @param pcb The process pcb to be added to the queue.
- */
-void putprocessInQueue(Scheduler *scheduler, int queueNbr, Node *node);
-
-/**
- * Get the first process node from the given queues, without dequeuining it.
  *
- * @param scheduler The scheduler.
- * 
- * @return The process Node, or NULL if the queue is empty.
+ * @return False if the memory for the queue could not be allocated, the node
+ *         is then in no queue.
  */
-Node *topReadyQueue(Scheduler *scheduler);
+bool putprocessInQueue(Scheduler *scheduler, int queueNbr, Node *node);
 
 /**
- * Dequeues the first process node from the given queues.
+ * Dequeues the first process node from the ready queues of a run queue.
  *
  * @param scheduler The scheduler.
+ * @param runQueueIndex The index of the run queue.
  * 
  * @return The process Node, or NULL if the queue is empty.
  */
-Node *dequeueTopReadyQueue(Scheduler *scheduler);
+Node *dequeueTopReadyQueue(Scheduler *scheduler, int runQueueIndex);
 
 /**
  * Removes a process node from the given queue.
@@ -82,30 +103,53 @@ Node *dequeueTopReadyQueue(Scheduler *scheduler);
 void removeReadyQueueNode(Scheduler *scheduler, int queueNbr, Node *node);
 
 /**
- * Processes the ready queues.
+ * Checks whether a process node is in one of the ready queues, in O(1).
  *
  * @param scheduler The scheduler.
- * @param pid The pid of the process to process.
+ * @param node The node of the process.
  * 
- * @return True if the process was found and processed, false otherwise.
+ * @return True if the node is in a ready queue, false otherwise.
  */
-bool processInReadyQueues(Scheduler *scheduler, int pid);
-
+bool nodeInReadyQueues(Scheduler *scheduler, const Node *node);
 
 /**
- * Print the ready queues to the console.
+ * Get the total time a process waited in the ready queues up to the current
+ * time of the scheduler. The waiting times are not advanced at each time unit
+ * but computed from the time at which the node entered its ready queue.
  *
  * @param scheduler The scheduler.
+ * @param node The node of the process.
+ *
+ * @return The waiting time of the process.
+ */
+int64_t getProcessWaitingTime(Scheduler *scheduler, const Node *node);
+
+
+/**
+ * Handles the scheduling events of the current time unit: aging, end of the
+ * context switches and of the interrupts, bursts over, queue limits,
+ * preemptions and round-robin slices.
+ *
+ * @param computer The computer.
+ * @param time The current time.
+ * @param stats The stats of the simulation.
+ *
+ * @return False if a process could not be put in the ready queues, the
+ *         simulation must then stop.
  */
-void handleSchedulerEvents(Computer *computer, int time, AllStats *stats);
+bool handleSchedulerEvents(Computer *computer, int64_t time, AllStats *stats);
 
 /**
- * Handles the process for the CPU.
+ * Handles the process for the CPU: puts it in the ready queues. With per-core
+ * run queues, the process goes to the run queue of the last core it ran on, or
+ * to the least loaded one if it never ran.
  *
  * @param scheduler The scheduler.
  * @param node The process node to handle.
+ *
+ * @return False if the process could not be put in the ready queues.
  */
-void handleProcessForCPU(Scheduler *scheduler, Node *node);
+bool handleProcessForCPU(Scheduler *scheduler, Node *node);
 
 /**
  * Handles the process for the disk.
@@ -116,7 +160,9 @@ void handleProcessForCPU(Scheduler *scheduler, Node *node);
 void handleProcessForDisk(Scheduler *scheduler, Node *node);
 
 /**
- * Assigns processes to resources.
+ * Assigns processes to resources. With per-core run queues, each idle core
+ * takes the first process of its own run queue, then the idle cores whose run
+ * queue is empty steal the first process of the busiest run queue.
  *
  * @param computer The computer.
  */
@@ -147,6 +193,19 @@ void putProcessOnDisk(Computer *computer, Node *node);
  * @param nextTime the next time step.
  * @param computer The computer.
  */
-void advanceSchedulingTime(int time, int nextTime, Computer *computer);
+void advanceSchedulingTime(int64_t time, int64_t nextTime, Computer *computer);
+
+/**
+ * Get the next time at which a scheduling event can be triggered: end of a
+ * switch in/out or interrupt timer, end of the current burst of a process on a
+ * core, end of a RR slice or --limit/--age threshold reached.
+ *
+ * @param computer The computer.
+ * @param time The current time.
+ *
+ * @return The next scheduling event time (strictly greater than time), or
+ *         INT64_MAX if no scheduling event is planned.
+ */
+int64_t getNextSchedulingEventTime(Computer *computer, int64_t time);
 
 #endif // schedulingLogic_h
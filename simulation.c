@@ -2,10 +2,23 @@
 // use the workload structure (either directly or through the getters and
 // setters).
 
+#define _POSIX_C_SOURCE 200112L // fdopen, posix_madvise
+
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include <limits.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <errno.h>
+#include <float.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "simulation.h"
 #include "process.h"
@@ -13,23 +26,32 @@
 #include "computer.h"
 #include "schedulingLogic.h"
 
-#define MAX_CHAR_PER_LINE 500
+#define PARSER_BUFFER_SIZE 65536 // bytes read from the input file at once
+#define PID_INDEX_DENSITY 2 // max PID range per process for the dense PID index
+#define NO_INDEX -1
+#define INITIAL_PROCESSES_CAPACITY 64
+#define INITIAL_EVENTS_CAPACITY 64
+#define MAX_EVENT_TYPE_LENGTH 8
+#define MAX_PARSE_ERROR_LENGTH 64
+#define PARALLEL_PARSE_MIN_BYTES (1 << 20) // min size of the part of the file parsed by a thread
+#define PROCESS_BLOCK_SIZE 1024 // process records allocated at once, they never move since the scheduler points to them
+
+// binary workload files, see saveBinaryWorkload in simulation.h
+#define BINARY_WORKLOAD_MAGIC "CPUWKLD" // 8 bytes with the final '\0'
+#define BINARY_WORKLOAD_MAGIC_SIZE 8
+#define BINARY_WORKLOAD_VERSION 1
+#define BINARY_HEADER_SIZE 64
+#define BINARY_EVENT_SIZE 16
 
 
 /* --------------------------- struct definitions -------------------------- */
 
 /**
  * The ProcessEvent strcut represent processes events as they are in the input
- * file (CPU or IO). They are represented as a linked list where each event
- * points to the next one.
+ * file (CPU or IO). The events of all processes are stored in a single array,
+ * the events of a process being contiguous and in the order of the file.
  */
 typedef struct ProcessEvent_t ProcessEvent;
-/**
- * The ProcessSimulationInfo struct contains all the input file information
- * and the advancement time of a particular process. The Workload struct
- * contains an array of ProcessSimulationInfo.
- */
-typedef struct ProcessSimulationInfo_t ProcessSimulationInfo;
 
 typedef enum
 {
@@ -39,24 +61,168 @@ typedef enum
 
 struct ProcessEvent_t
 {
-    ProcessEventType type;
-    int time; // Time at which the event occurs. /!\ time relative to the process
-    ProcessEvent *nextEvent; // Pointer to the next event in the queue
+    int64_t time; // Time at which the event occurs. /!\ time relative to the process
+    int32_t type; // ProcessEventType, fixed width to be used as is from binary workload files
 };
 
-struct ProcessSimulationInfo_t
+/*
+ * The Workload struct contains all the input file information as a struct of
+ * arrays: the information of the process at index i (in the order of the
+ * input file) is at index i of each array, so that the passes over all
+ * processes read contiguous memory. It is read-only once the file is parsed.
+ */
+struct Workload_t
 {
-    PCB *pcb;
-    int startTime;
-    int processDuration; // CPU + IO !
-    int advancementTime; // CPU + IO !
-    ProcessEvent *nextEvent; // Pointer to the next event after the current one
+    int nbProcesses;
+
+    int *pids;
+    int *priorities;
+    int64_t *startTimes;
+    int64_t *processDurations; // CPU + IO !
+    // the events of process i are events[eventStarts[i]] to events[eventEnds[i] - 1]
+    // (eventEnds is eventStarts + 1, except in the window of a streamed simulation)
+    int64_t *eventStarts;
+    int64_t *eventEnds;
+
+    ProcessEvent *events;
+    int64_t nbEvents;
+
+    // PID -> index in the arrays, built once the file is parsed
+    // * dense: pidIndex[pid - minPID] when the PIDs are compact
+    // * otherwise: open-addressing hash table (linear probing) of size
+    //   pidIndexSize (a power of 2), pidIndexKeys[i] being the PID stored
+    //   in the slot i (NO_INDEX in pidIndex if the slot is empty)
+    bool densePIDIndex;
+    int minPID;
+    int pidIndexSize;
+    int *pidIndexKeys;
+    int *pidIndex;
+
+    // indexes of the processes sorted by start time (stable: input order for
+    // the same start time)
+    int *arrivalOrder;
+
+    // binary workload file mapped by loadBinaryWorkload, the arrays above
+    // (except the PID index) point inside it (NULL for a parsed text file)
+    void *mapping;
+    size_t mappingSize;
 };
 
-struct Workload_t
+typedef struct ProcessStream_t ProcessStream;
+
+/*
+ * The ProcessRecord struct contains what the simulation keeps for a process:
+ * its PCB and its node in the queues of the scheduler. The node is part of the
+ * record and reset at each arrival, so that no node is allocated or freed
+ * during the simulation.
+ */
+typedef struct ProcessRecord_t ProcessRecord;
+struct ProcessRecord_t
 {
-    ProcessSimulationInfo **processesInfo;
-    int nbProcesses;
+    PCB pcb;
+    Node node;
+};
+
+/*
+ * The SimulationState struct contains the advancement of the processes of a
+ * workload during a simulation, with the same indexes as the workload.
+ */
+struct SimulationState_t
+{
+    const Workload *workload;
+
+    // PCB and node of the processes (shared with the scheduler), the record of
+    // process i is processBlocks[i / PROCESS_BLOCK_SIZE][i % PROCESS_BLOCK_SIZE]
+    ProcessRecord **processBlocks;
+    int nbProcessBlocks;
+    int64_t *advancementTimes; // CPU + IO !
+    // events[nextEvents[i]] is the next event of process i after the current one
+    int64_t *nextEvents;
+    // position in workload->arrivalOrder of the next process to arrive
+    int nextArrival;
+    // indexes of the processes arrived and not terminated yet, in order of
+    // arrival: the only ones visited at each step of the simulation
+    int *activeProcesses;
+    int nbActiveProcesses;
+
+    // streamed simulation only (see launchStreamedSimulation), NULL otherwise
+    ProcessStream *stream;
+};
+
+/**
+ * State of the parsing of an input file, parsed character by character in a
+ * single pass, so that the length of the lines is not limited. Regular files
+ * are mapped in memory and parsed in place (buffer is the whole file and file
+ * is NULL), the others (pipes, ...) are read by blocks of PARSER_BUFFER_SIZE
+ * bytes.
+ */
+typedef struct InputParser_t InputParser;
+struct InputParser_t
+{
+    FILE *file; // NULL if the file is mapped
+    const char *fileName;
+    char *buffer;
+    size_t length; // number of bytes in the buffer
+    size_t position; // position of the next character in the buffer
+    // position of the next character in the file (starting at 1)
+    int64_t line;
+    int64_t column;
+
+    int processesCapacity; // size of the arrays of the processes in the workload
+    int64_t eventsCapacity; // size of the events array in the workload
+
+    // first parse error, printed once the whole file is parsed (see printParseError)
+    bool hasError;
+    int64_t errorLine;
+    int64_t errorColumn;
+    char errorMessage[MAX_PARSE_ERROR_LENGTH];
+};
+
+/**
+ * Part of a mapped input file parsed by one thread (starting at the beginning
+ * of a line), into its own workload merged with the others afterwards.
+ */
+typedef struct ParseChunk_t ParseChunk;
+struct ParseChunk_t
+{
+    InputParser parser; // parser of the part of the file only
+    Workload *workload;
+    bool success;
+};
+
+/**
+ * Input file read during a streamed simulation. The workload of the
+ * simulation is then a window holding the processes read from the file and
+ * not terminated yet: the index of a terminated process is reused by a later
+ * one and its events are dropped when the events array is compacted.
+ */
+struct ProcessStream_t
+{
+    InputParser parser; // read by blocks, the file is never fully in memory
+    Workload *window; // same as the workload of the state, but writable
+    Workload *scratch; // the last process parsed, before it is copied to the window
+    int capacity; // number of indexes allocated in the window and the state
+    int64_t eventsCapacity; // size of the events array of the window
+    int64_t nbLiveEvents; // events of the processes in the window
+
+    bool *used; // used[i]: a process of the window has the index i
+    int *freeIndexes; // indexes < window->nbProcesses not used anymore
+    int nbFreeIndexes;
+    int nbActive; // processes in the window, including the next arrival
+
+    int nextArrival; // index of the next process to arrive (NO_INDEX: none)
+    int64_t lastStartTime; // to check that the file is sorted by start time
+    bool failed; // the file could not be read to the end
+};
+
+/**
+ * Used to sort the processes by start time.
+ */
+typedef struct ProcessArrival_t ProcessArrival;
+struct ProcessArrival_t
+{
+    int64_t startTime;
+    int index;
 };
 
 /* ---------------------------- static functions --------------------------- */
@@ -68,70 +234,512 @@ struct Workload_t
  * @param workload: the workload
  * @param pid: the pid of the process
  *
- * @return the index of the process in the workload
+ * @return the index of the process in the workload, or NO_INDEX if there is
+ *         no process with this pid
+ */
+static int getProcessIndex(const Workload *workload, int pid);
+
+/**
+ * Return the first slot of the probe sequence of the given pid in the hashed
+ * PID index of the workload.
+ *
+ * @param workload: the workload
+ * @param pid: the pid
+ *
+ * @return the slot where the pid is stored without collision
+ */
+static unsigned int getPIDIndexHome(const Workload *workload, int pid);
+
+/**
+ * Open the given input file for parsing: map it in memory if possible and
+ * requested, otherwise prepare to read it by blocks.
+ *
+ * @param parser: the parser to initialize
+ * @param fileName: the name of the input file
+ * @param mapFile: true to map a regular file in memory, false to always read
+ *                 it by blocks (bounded memory)
+ *
+ * @return true on success, false otherwise (error reported)
+ */
+static bool openInputParser(InputParser *parser, const char *fileName, bool mapFile);
+
+/**
+ * Close the input file of the parser and release its buffer or mapping.
+ *
+ * @param parser: the parser
+ */
+static void closeInputParser(InputParser *parser);
+
+/**
+ * Return the next character of the input file without consuming it.
+ *
+ * @param parser: the parser
+ *
+ * @return the next character, or EOF at the end of the file (or on error)
+ */
+static int peekInputChar(InputParser *parser);
+
+/**
+ * Consume the next character of the input file.
+ *
+ * @param parser: the parser
+ *
+ * @return the consumed character, or EOF at the end of the file (or on error)
+ */
+static int readInputChar(InputParser *parser);
+
+/**
+ * Consume the spaces (but not the newlines) at the current position.
+ *
+ * @param parser: the parser
+ */
+static void skipInputSpaces(InputParser *parser);
+
+/**
+ * Consume the rest of the current line, including the newline.
+ *
+ * @param parser: the parser
+ */
+static void skipInputLine(InputParser *parser);
+
+/**
+ * Record an error about the input file on the current line of the parser (only
+ * the first one is kept).
+ *
+ * @param parser: the parser
+ * @param column: the column of the error
+ * @param message: the description of the error
+ */
+static void reportParseError(InputParser *parser, int64_t column, const char *message);
+
+/**
+ * Print the error recorded by the parser.
+ *
+ * @param parser: the parser
+ * @param lineOffset: the number of lines of the file before the part parsed
+ *                    by this parser
+ */
+static void printParseError(const InputParser *parser, int64_t lineOffset);
+
+/**
+ * Skip the spaces, comments and empty lines of the input file.
+ *
+ * @param parser: the parser
+ *
+ * @return the first character of the next process, or EOF
+ */
+static int skipInputBlankLines(InputParser *parser);
+
+/**
+ * Allocate a new empty workload with the given capacities.
+ *
+ * @param processesCapacity: the initial size of the arrays of the processes
+ * @param eventsCapacity: the initial size of the events array
+ *
+ * @return the new workload, or NULL on allocation failure
+ */
+static Workload *initEmptyWorkload(int processesCapacity, int64_t eventsCapacity);
+
+/**
+ * Allocate a new empty workload to be filled by the parser.
+ *
+ * @param parser: the parser
+ *
+ * @return the new workload, or NULL on allocation failure
+ */
+static Workload *initParsedWorkload(InputParser *parser);
+
+/**
+ * Parse all the lines of the input file (or of the part of it given to the
+ * parser) into the workload.
+ *
+ * @param parser: the parser
+ * @param workload: the workload to fill
+ *
+ * @return true on success, false otherwise (error recorded or reported)
+ */
+static bool parseInputLines(InputParser *parser, Workload *workload);
+
+/**
+ * Parse a chunk of the input file, used as thread function.
+ *
+ * @param arg: the ParseChunk to parse
+ *
+ * @return NULL
+ */
+static void *parseInputChunk(void *arg);
+
+/**
+ * Merge the workloads parsed from the chunks of the input file, in the order
+ * of the file.
+ *
+ * @param chunks: the parsed chunks
+ * @param nbChunks: the number of chunks
+ *
+ * @return the merged workload, or NULL on allocation failure
+ */
+static Workload *mergeParseChunks(ParseChunk *chunks, int nbChunks);
+
+/**
+ * Consume the given character, after optional spaces.
+ *
+ * @param parser: the parser
+ * @param expected: the expected character
+ *
+ * @return true if the character was found, false otherwise (error reported)
+ */
+static bool expectInputChar(InputParser *parser, char expected);
+
+/**
+ * Parse an integer in the given range, after optional spaces.
+ *
+ * @param parser: the parser
+ * @param minValue: the minimum accepted value
+ * @param maxValue: the maximum accepted value
+ * @param value: where to store the integer
+ *
+ * @return true on success, false otherwise (error reported)
+ */
+static bool parseInputInteger(InputParser *parser, int64_t minValue, int64_t maxValue, int64_t *value);
+
+/**
+ * Parse an event of a process, "(time, CPU)" or "(time, IO)", and append it
+ * to the events of the workload.
+ *
+ * @param parser: the parser
+ * @param workload: the workload being parsed
+ *
+ * @return true on success, false otherwise (error reported)
+ */
+static bool parseInputEvent(InputParser *parser, Workload *workload);
+
+/**
+ * Parse the line of a process and append it to the workload.
+ *
+ * @param parser: the parser
+ * @param workload: the workload being parsed
+ *
+ * @return true on success, false otherwise (error reported)
+ */
+static bool parseInputProcess(InputParser *parser, Workload *workload);
+
+/**
+ * Grow the arrays of the processes of the workload to the given capacity.
+ *
+ * @param workload: the workload
+ * @param capacity: the new number of processes the arrays can contain
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool growWorkloadProcesses(Workload *workload, int capacity);
+
+/**
+ * Write an unsigned integer in little-endian order.
+ *
+ * @param file: the file to write to
+ * @param value: the value to write
+ * @param size: the number of bytes to write
+ *
+ * @return true on success, false otherwise
+ */
+static bool writeLittleEndian(FILE *file, uint64_t value, int size);
+
+/**
+ * Read an unsigned integer stored in little-endian order.
+ *
+ * @param bytes: the bytes to read
+ * @param size: the number of bytes to read
+ *
+ * @return the value read
+ */
+static uint64_t readLittleEndian(const unsigned char *bytes, int size);
+
+/**
+ * Return the size of the process table of a binary workload file.
+ *
+ * @param nbProcesses: the number of processes
+ *
+ * @return the size of the process table, in bytes
+ */
+static uint64_t getBinaryProcessTableSize(uint64_t nbProcesses);
+
+/**
+ * Check that the tables of a binary workload file are consistent, as a parsed
+ * text input file, in a single pass over the tables:
+ * * start times and durations not negative
+ * * events of the processes inside the burst table, of a known type and
+ *   inside the process (time in [0, duration))
+ * * arrival order sorted by start time then by index (so it is a
+ *   permutation of the processes: no process arrives twice)
+ *
+ * @param workload: the workload loaded from the file
+ *
+ * @return true if the workload is consistent, false otherwise
  */
-static int getProcessIndex(Workload *workload, int pid);
+static bool checkBinaryWorkload(const Workload *workload);
 
 /**
- * Set the advancement time of the process with the given pid in the workload.
+ * Return the slot of the given pid in the hash table of the PID index: either
+ * the slot containing it or the empty slot where it should be inserted.
  *
  * @param workload: the workload
  * @param pid: the pid of the process
- * @param advancementTime: the new advancement time
+ *
+ * @return the slot of the pid in the hash table
+ */
+static int getPIDIndexSlot(const Workload *workload, int pid);
+
+/**
+ * Build the PID -> index map of the workload once all processes are parsed.
+ *
+ * @param workload: the workload
+ *
+ * @return true on success, false on allocation failure or duplicated PID
+ */
+static bool buildPIDIndex(Workload *workload);
+
+/**
+ * Compare two process arrivals by start time then by index in the workload.
+ *
+ * @param a: the first ProcessArrival
+ * @param b: the second ProcessArrival
+ *
+ * @return a negative, zero or positive value as for qsort
  */
-static void setProcessAdvancementTime(Workload *workload, int pid, int advancementTime);
+static int compareProcessArrivals(const void *a, const void *b);
+
+/**
+ * Build the array of processes sorted by start time used to admit the
+ * processes, once the file is parsed.
+ *
+ * @param workload: the workload
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool buildArrivalOrder(Workload *workload);
 
 /*
  * Returns true if all processes in the workload have finished
  * (advancementTime == processDuration).
  *
- * @param workload: the workload
+ * @param state: the state of the simulation
  * @return true if all processes have finished, false otherwise
  */
-static bool workloadOver(const Workload *workload);
+static bool workloadOver(const SimulationState *state);
+
+static void addAllProcessesToStats(AllStats *stats, const Workload *workload);
+
+/**
+ * Add new stats for the process at the given index in the workload.
+ *
+ * @param stats The stats of the simulation.
+ * @param workload The workload.
+ * @param index The index of the process.
+ * @return true on success, false on allocation failure.
+ */
+static bool addProcessToStats(AllStats *stats, const Workload *workload, int index);
+
+/**
+ * Allocate the records (PCB and node) of the processes up to the given
+ * number, by blocks.
+ *
+ * @param state The state of the simulation.
+ * @param nbProcesses The number of processes that need a record.
+ * @return true on success, false on allocation failure.
+ */
+static bool growStateProcesses(SimulationState *state, int nbProcesses);
+
+/**
+ * Simulate the workload of the given state, from its current state.
+ *
+ * @param state The state of the simulation.
+ * @param algorithms The algorithms of the ready queues (see launchSimulation).
+ * @param algorithmCount The number of ready queues.
+ * @param cpuCoreCount The number of CPU cores.
+ * @param graph The graph of the simulation (can be NULL).
+ * @param stats The statistics of the simulation.
+ * @param options The options of the simulation.
+ * @return true if the simulation could be launched, false otherwise (the
+ *         algorithms are freed in any case, with the scheduler).
+ */
+static bool runSimulation(SimulationState *state, SchedulingAlgorithm **algorithms, int algorithmCount, int cpuCoreCount, ProcessGraph *graph, AllStats *stats, const SimulationOptions *options);
+
+/**
+ * Report that the simulation stopped before the end of the workload: on
+ * stderr, or in the stop warning buffer of the options if there is one.
+ *
+ * @param options The options of the simulation.
+ * @param format The printf format of the warning, followed by its arguments.
+ */
+static void warnSimulationStop(const SimulationOptions *options, const char *format, ...);
+
+/**
+ * Free the algorithms of the ready queues and their array, when the simulation
+ * fails before they are handed to the scheduler.
+ *
+ * @param algorithms The algorithms of the ready queues.
+ * @param algorithmCount The number of ready queues.
+ */
+static void freeSchedulingAlgorithms(SchedulingAlgorithm **algorithms, int algorithmCount);
+
+/**
+ * Record in the stats the waiting times of the processes that are not
+ * terminated (the waiting time of a terminated process is recorded when it
+ * terminates), for a simulation stopped before the end of the workload.
+ *
+ * @param state The state of the simulation.
+ * @param scheduler The scheduler of the simulation.
+ * @param stats The statistics of the simulation.
+ */
+static void recordWaitingTimes(SimulationState *state, Scheduler *scheduler, AllStats *stats);
+
+/**
+ * Create the state of a streamed simulation of the given input file and read
+ * its first process.
+ *
+ * @param fileName The name of the input file.
+ * @param stats The statistics of the simulation.
+ * @return The new state, or NULL on error (reported).
+ */
+static SimulationState *initStreamedSimulationState(const char *fileName, AllStats *stats);
+
+/**
+ * Double the number of indexes of the window of a streamed simulation (and of
+ * the arrays of the state and the stats).
+ *
+ * @param state The state of the streamed simulation.
+ * @param stats The statistics of the simulation.
+ * @return true on success, false on allocation failure.
+ */
+static bool growStreamWindow(SimulationState *state, AllStats *stats);
+
+/**
+ * Make room for the given number of events at the end of the events array of
+ * the window of a streamed simulation, dropping the events of the terminated
+ * processes if needed.
+ *
+ * @param state The state of the streamed simulation.
+ * @param nbEvents The number of events to add.
+ * @return true on success, false on allocation failure.
+ */
+static bool reserveStreamEvents(SimulationState *state, int64_t nbEvents);
+
+/**
+ * Add the given pid to the PID index of the window of a streamed simulation,
+ * growing the index if needed.
+ *
+ * @param stream The stream of the simulation.
+ * @param pid The pid of the process.
+ * @param index The index of the process in the window.
+ * @return true on success, false on allocation failure.
+ */
+static bool insertStreamedPID(ProcessStream *stream, int pid, int index);
+
+/**
+ * Remove the given pid from the PID index of the window of a streamed
+ * simulation.
+ *
+ * @param stream The stream of the simulation.
+ * @param pid The pid of the process.
+ */
+static void removeStreamedPID(ProcessStream *stream, int pid);
+
+/**
+ * Read the next process of the input file of a streamed simulation into the
+ * window, as the next process to arrive. On error (reported), the stream is
+ * marked as failed.
+ *
+ * @param state The state of the streamed simulation.
+ * @param stats The statistics of the simulation.
+ */
+static void readStreamedProcess(SimulationState *state, AllStats *stats);
+
+/**
+ * Release the processes of the window of a streamed simulation that are
+ * terminated: their index is reused and their stats are retired.
+ *
+ * @param state The state of the streamed simulation.
+ * @param stats The statistics of the simulation.
+ */
+static void releaseTerminatedProcesses(SimulationState *state, AllStats *stats);
 
-static void addAllProcessesToStats(AllStats *stats, Workload *workload);
+/**
+ * Free the given stream and its window.
+ *
+ * @param stream The stream to free.
+ */
+static void freeProcessStream(ProcessStream *stream);
 
 /**
- * Retrieves the PCB (Process Control Block) from the given Workload at the specified index.
+ * Retrieves the PCB (Process Control Block) from the given SimulationState at the specified index.
  *
- * @param workload The Workload from which to retrieve the PCB.
+ * @param state The SimulationState from which to retrieve the PCB.
  * @param index The index of the PCB to retrieve.
  * @return A pointer to the PCB at the specified index, or NULL if the index is out of bounds.
  */
-static PCB *getPCBFromWorkload(Workload *workload, int index);
+static PCB *getPCBFromState(const SimulationState *state, int index);
+
+/**
+ * Retrieves the queue node of the process at the specified index of the given
+ * SimulationState.
+ *
+ * @param state The SimulationState from which to retrieve the node.
+ * @param index The index of the process.
+ * @return A pointer to the node of the process.
+ */
+static Node *getNodeFromState(const SimulationState *state, int index);
 
 /**
  * Handles the events of the simulation.
  *
  * @param computer The computer on which the simulation is running.
- * @param workload The workload of the simulation.
+ * @param state The state of the simulation.
  * @param time The current time of the simulation.
  * @param stats The statistics of the simulation.
+ *
+ * @return False if a process could not be put in the ready queues.
  */
-static void handleSimulationEvents(Computer *computer, Workload *workload, int time, AllStats *stats);
+static bool handleSimulationEvents(Computer *computer, SimulationState *state, int64_t time, AllStats *stats);
 
 /**
  * Handles the events of the simulation.
  *
  * @param scheduler The scheduler of the simulation.
- * @param workload The workload of the simulation.
+ * @param state The state of the simulation.
  * @param time The current time of the simulation.
  * @param stats The statistics of the simulation.
+ *
+ * @return False if an arriving process could not be put in the ready queues.
  */
-static void processArrived(Scheduler *scheduler, Workload *workload, int time, AllStats *stats);
+static bool processArrived(Scheduler *scheduler, SimulationState *state, int64_t time, AllStats *stats);
 
 /**
  * Advances the time of the processes in the workload and the scheduler.
  *
  * @param time The current time of the simulation.
  * @param nextTime The next time of the simulation.
- * @param workload The workload of the simulation.
+ * @param simulationState The state of the simulation.
  * @param computer The computer on which the simulation is running.
  * @param graph The graph of the simulation.
  * @param stats The statistics of the simulation.
+ *
+ * @return true if a process progressed (on a core or on the disk) or no
+ *         process is in the system, false if the processes are all stalled
+ */
+static bool advanceProcessTime(int64_t time, int64_t nextTime, SimulationState *simulationState, Computer *computer, ProcessGraph *graph, AllStats *stats);
+
+/**
+ * Returns the next time at which an event can be triggered in the simulation
+ * (arrival, end of a CPU or IO burst, timer expiry, ...). Nothing can change
+ * in the simulation between the current time and the returned time, so the
+ * main loop can directly jump to it.
+ *
+ * @param computer The computer on which the simulation is running.
+ * @param state The state of the simulation.
+ * @param time The current time of the simulation.
+ * @return The next event time, always strictly greater than time.
  */
-static void advanceProcessTime(int time, int nextTime, Workload *workload, Computer *computer, ProcessGraph *graph, AllStats *stats);
+static int64_t getNextSimulationEventTime(Computer *computer, const SimulationState *state, int64_t time);
 
 /* -------------------------- getters and setters -------------------------- */
 
@@ -140,280 +748,1621 @@ int getProcessCount(const Workload *workload)
     return workload->nbProcesses;
 }
 
-int getPIDFromWorkload(Workload *workload, int index)
-{
-    return workload->processesInfo[index]->pcb->pid;
+int getPIDFromWorkload(const Workload *workload, int index)
+{
+    return workload->pids[index];
+}
+
+int64_t getProcessStartTime(const Workload *workload, int pid)
+{
+    int index = getProcessIndex(workload, pid);
+    if (index == NO_INDEX)
+    {
+        return -1;
+    }
+    return workload->startTimes[index];
+}
+
+int64_t getProcessDuration(const Workload *workload, int pid)
+{
+    int index = getProcessIndex(workload, pid);
+    if (index == NO_INDEX)
+    {
+        return -1;
+    }
+    return workload->processDurations[index];
+}
+
+int64_t getProcessAdvancementTime(const SimulationState *state, int pid)
+{
+    int index = getProcessIndex(state->workload, pid);
+    if (index == NO_INDEX)
+    {
+        return -1;
+    }
+    return state->advancementTimes[index];
+}
+
+int64_t getProcessNextEventTime(const SimulationState *state, int pid)
+{
+    const Workload *workload = state->workload;
+    int index = getProcessIndex(workload, pid);
+    if (index == NO_INDEX)
+    {
+        return -1;
+    }
+    if (state->nextEvents[index] < workload->eventEnds[index])
+    {
+        return workload->events[state->nextEvents[index]].time; // relative to the process
+    }
+    return workload->processDurations[index];
+}
+
+int64_t getProcessCurEventTimeLeft(const SimulationState *state, int pid)
+{
+    return getProcessNextEventTime(state, pid)
+           - getProcessAdvancementTime(state, pid);
+}
+
+static int getProcessIndex(const Workload *workload, int pid)
+{
+    if (workload->densePIDIndex)
+    {
+        // unsigned comparison also rejects pid < minPID
+        if ((unsigned int) pid - (unsigned int) workload->minPID >= (unsigned int) workload->pidIndexSize)
+        {
+            return NO_INDEX;
+        }
+        return workload->pidIndex[pid - workload->minPID];
+    }
+    return workload->pidIndex[getPIDIndexSlot(workload, pid)];
+}
+
+static unsigned int getPIDIndexHome(const Workload *workload, int pid)
+{
+    return getHashHome(pid, workload->pidIndexSize);
+}
+
+static int getPIDIndexSlot(const Workload *workload, int pid)
+{
+    unsigned int mask = (unsigned int) workload->pidIndexSize - 1;
+    unsigned int slot = getPIDIndexHome(workload, pid);
+    while (workload->pidIndex[slot] != NO_INDEX && workload->pidIndexKeys[slot] != pid)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static bool buildPIDIndex(Workload *workload)
+{
+    int minPID = 0;
+    int maxPID = -1;
+    for (int i = 0; i < workload->nbProcesses; i++)
+    {
+        int pid = getPIDFromWorkload(workload, i);
+        if (i == 0 || pid < minPID)
+            minPID = pid;
+        if (i == 0 || pid > maxPID)
+            maxPID = pid;
+    }
+
+    int64_t pidRange = (int64_t) maxPID - minPID + 1;
+    workload->densePIDIndex = pidRange <= (int64_t) PID_INDEX_DENSITY * workload->nbProcesses + 1;
+    workload->minPID = minPID;
+    if (workload->densePIDIndex)
+    {
+        workload->pidIndexSize = (int) pidRange;
+    }
+    else
+    {
+        // load factor <= 1/2 to keep the probe sequences short
+        workload->pidIndexSize = 1;
+        while (workload->pidIndexSize < 2 * workload->nbProcesses)
+            workload->pidIndexSize *= 2;
+        workload->pidIndexKeys = (int *) malloc(workload->pidIndexSize * sizeof(int));
+        if (!workload->pidIndexKeys)
+        {
+            fprintf(stderr, "Error: could not allocate memory for the PID index\n");
+            return false;
+        }
+    }
+
+    workload->pidIndex = (int *) malloc(workload->pidIndexSize * sizeof(int));
+    if (!workload->pidIndex)
+    {
+        fprintf(stderr, "Error: could not allocate memory for the PID index\n");
+        return false;
+    }
+    for (int i = 0; i < workload->pidIndexSize; i++)
+    {
+        workload->pidIndex[i] = NO_INDEX;
+    }
+
+    for (int i = 0; i < workload->nbProcesses; i++)
+    {
+        int pid = getPIDFromWorkload(workload, i);
+        int slot = workload->densePIDIndex ? pid - minPID : getPIDIndexSlot(workload, pid);
+        if (workload->pidIndex[slot] != NO_INDEX)
+        {
+            fprintf(stderr, "Error: PID %d is used by several processes\n", pid);
+            return false;
+        }
+        if (!workload->densePIDIndex)
+        {
+            workload->pidIndexKeys[slot] = pid;
+        }
+        workload->pidIndex[slot] = i;
+    }
+
+    return true;
+}
+
+static int compareProcessArrivals(const void *a, const void *b)
+{
+    const ProcessArrival *arrivalA = (const ProcessArrival *) a;
+    const ProcessArrival *arrivalB = (const ProcessArrival *) b;
+    if (arrivalA->startTime != arrivalB->startTime)
+    {
+        return arrivalA->startTime < arrivalB->startTime ? -1 : 1;
+    }
+    return arrivalA->index - arrivalB->index;
+}
+
+static bool buildArrivalOrder(Workload *workload)
+{
+    ProcessArrival *arrivals = (ProcessArrival *) malloc(workload->nbProcesses * sizeof(ProcessArrival));
+    workload->arrivalOrder = (int *) malloc(workload->nbProcesses * sizeof(int));
+    if (!arrivals || !workload->arrivalOrder)
+    {
+        fprintf(stderr, "Error: could not allocate memory for the arrival order\n");
+        free(arrivals);
+        return false;
+    }
+
+    for (int i = 0; i < workload->nbProcesses; i++)
+    {
+        arrivals[i].startTime = workload->startTimes[i];
+        arrivals[i].index = i;
+    }
+    qsort(arrivals, workload->nbProcesses, sizeof(ProcessArrival), compareProcessArrivals);
+    for (int i = 0; i < workload->nbProcesses; i++)
+    {
+        workload->arrivalOrder[i] = arrivals[i].index;
+    }
+
+    free(arrivals);
+    return true;
+}
+
+int64_t getNextArrivalTime(const SimulationState *state)
+{
+    const Workload *workload = state->workload;
+    if (state->stream)
+    {
+        int index = state->stream->nextArrival;
+        return index == NO_INDEX ? INT64_MAX : workload->startTimes[index];
+    }
+    if (state->nextArrival >= workload->nbProcesses)
+    {
+        return INT64_MAX;
+    }
+    return workload->startTimes[workload->arrivalOrder[state->nextArrival]];
+}
+
+const Workload *getSimulationWorkload(const SimulationState *state)
+{
+    return state->workload;
+}
+
+static PCB *getPCBFromState(const SimulationState *state, int index)
+{
+    return &state->processBlocks[index / PROCESS_BLOCK_SIZE][index % PROCESS_BLOCK_SIZE].pcb;
+}
+
+static Node *getNodeFromState(const SimulationState *state, int index)
+{
+    return &state->processBlocks[index / PROCESS_BLOCK_SIZE][index % PROCESS_BLOCK_SIZE].node;
+}
+
+/* ------------------------- binary workload files ------------------------- */
+
+static bool writeLittleEndian(FILE *file, uint64_t value, int size)
+{
+    unsigned char bytes[8];
+    for (int i = 0; i < size; i++)
+    {
+        bytes[i] = (unsigned char) (value >> (8 * i));
+    }
+    return fwrite(bytes, 1, size, file) == (size_t) size;
+}
+
+static uint64_t readLittleEndian(const unsigned char *bytes, int size)
+{
+    uint64_t value = 0;
+    for (int i = size - 1; i >= 0; i--)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+static uint64_t getBinaryProcessTableSize(uint64_t nbProcesses)
+{
+    // startTimes, processDurations, eventStarts (n + 1), then pids, priorities
+    // and arrivalOrder, padded to 8 bytes
+    uint64_t size = 8 * (3 * nbProcesses + 1) + 4 * 3 * nbProcesses;
+    return (size + 7) / 8 * 8;
+}
+
+static bool checkBinaryWorkload(const Workload *workload)
+{
+    int n = workload->nbProcesses;
+    if (workload->eventStarts[0] != 0 || workload->eventStarts[n] != workload->nbEvents)
+    {
+        return false;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        if (workload->eventStarts[i] > workload->eventStarts[i + 1]
+            || workload->startTimes[i] < 0 || workload->processDurations[i] < 0)
+        {
+            return false;
+        }
+        for (int64_t e = workload->eventStarts[i]; e < workload->eventStarts[i + 1]; e++)
+        {
+            const ProcessEvent *event = &workload->events[e];
+            if ((event->type != CPU_BURST && event->type != IO_BURST)
+                || event->time < 0 || event->time >= workload->processDurations[i]
+                || (e > workload->eventStarts[i] && event->type == workload->events[e - 1].type))
+            {
+                return false;
+            }
+        }
+
+        // strictly increasing (start time, index): each index at most once
+        int index = workload->arrivalOrder[i];
+        if (index < 0 || index >= n)
+        {
+            return false;
+        }
+        if (i > 0)
+        {
+            int previous = workload->arrivalOrder[i - 1];
+            if (workload->startTimes[previous] > workload->startTimes[index]
+                || (workload->startTimes[previous] == workload->startTimes[index] && previous >= index))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* ------------------------------ input parser ----------------------------- */
+
+static bool openInputParser(InputParser *parser, const char *fileName, bool mapFile)
+{
+    parser->file = NULL;
+    parser->fileName = fileName;
+    parser->buffer = NULL;
+    parser->length = 0;
+    parser->position = 0;
+    parser->line = 1;
+    parser->column = 1;
+    parser->processesCapacity = 0;
+    parser->eventsCapacity = INITIAL_EVENTS_CAPACITY;
+    parser->hasError = false;
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd == -1)
+    {
+        fprintf(stderr, "Error: could not open file %s\n", fileName);
+        return false;
+    }
+
+    // zero-copy: the numbers are parsed directly from the pages of the file
+    struct stat fileStat;
+    if (mapFile && fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode) && fileStat.st_size > 0
+        && (uintmax_t) fileStat.st_size <= SIZE_MAX)
+    {
+        size_t size = (size_t) fileStat.st_size;
+        void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            close(fd); // the mapping stays valid
+            posix_madvise(mapping, size, POSIX_MADV_SEQUENTIAL);
+            parser->buffer = (char *) mapping;
+            parser->length = size;
+            return true;
+        }
+    }
+
+    // not a regular file (or empty, or cannot be mapped, or not requested): read by blocks
+    parser->file = fdopen(fd, "r");
+    if (!parser->file)
+    {
+        fprintf(stderr, "Error: could not open file %s\n", fileName);
+        close(fd);
+        return false;
+    }
+    parser->buffer = (char *) malloc(PARSER_BUFFER_SIZE);
+    if (!parser->buffer)
+    {
+        fprintf(stderr, "Error: could not allocate memory to read file %s\n", fileName);
+        fclose(parser->file);
+        return false;
+    }
+    return true;
+}
+
+static void closeInputParser(InputParser *parser)
+{
+    if (parser->file)
+    {
+        free(parser->buffer);
+        fclose(parser->file);
+    }
+    else
+    {
+        munmap(parser->buffer, parser->length);
+    }
+}
+
+static int peekInputChar(InputParser *parser)
+{
+    if (parser->position == parser->length)
+    {
+        if (!parser->file)
+        {
+            return EOF; // the whole file is mapped
+        }
+        parser->length = fread(parser->buffer, 1, PARSER_BUFFER_SIZE, parser->file);
+        parser->position = 0;
+        if (parser->length == 0)
+        {
+            return EOF;
+        }
+    }
+    return (unsigned char) parser->buffer[parser->position];
+}
+
+static int readInputChar(InputParser *parser)
+{
+    int c = peekInputChar(parser);
+    if (c == EOF)
+    {
+        return EOF;
+    }
+    parser->position++;
+    if (c == '\n')
+    {
+        parser->line++;
+        parser->column = 1;
+    }
+    else
+    {
+        parser->column++;
+    }
+    return c;
+}
+
+static void skipInputSpaces(InputParser *parser)
+{
+    int c = peekInputChar(parser);
+    while (c == ' ' || c == '\t' || c == '\r')
+    {
+        parser->position++; // not a newline: same line
+        parser->column++;
+        c = peekInputChar(parser);
+    }
+}
+
+static void skipInputLine(InputParser *parser)
+{
+    int c = readInputChar(parser);
+    while (c != '\n' && c != EOF)
+    {
+        c = readInputChar(parser);
+    }
+}
+
+static void reportParseError(InputParser *parser, int64_t column, const char *message)
+{
+    if (parser->hasError)
+    {
+        return;
+    }
+    parser->hasError = true;
+    parser->errorLine = parser->line;
+    parser->errorColumn = column;
+    snprintf(parser->errorMessage, MAX_PARSE_ERROR_LENGTH, "%s", message);
+}
+
+static void printParseError(const InputParser *parser, int64_t lineOffset)
+{
+    fprintf(stderr, "Error: %s:%" PRId64 ":%" PRId64 ": %s\n", parser->fileName,
+            lineOffset + parser->errorLine, parser->errorColumn, parser->errorMessage);
+}
+
+static Workload *initEmptyWorkload(int processesCapacity, int64_t eventsCapacity)
+{
+    Workload *workload = (Workload *) malloc(sizeof(Workload));
+    if (!workload)
+    {
+        fprintf(stderr, "Error: could not allocate memory for workload\n");
+        return NULL;
+    }
+    workload->nbProcesses = 0;
+    workload->pids = NULL;
+    workload->priorities = NULL;
+    workload->startTimes = NULL;
+    workload->processDurations = NULL;
+    workload->eventStarts = NULL;
+    workload->eventEnds = NULL;
+    workload->events = (ProcessEvent *) malloc(sizeof(ProcessEvent) * (eventsCapacity > 0 ? eventsCapacity : 1));
+    workload->nbEvents = 0;
+    workload->pidIndexKeys = NULL;
+    workload->pidIndex = NULL;
+    workload->arrivalOrder = NULL;
+    workload->mapping = NULL;
+    workload->mappingSize = 0;
+
+    if (!workload->events || !growWorkloadProcesses(workload, processesCapacity > 0 ? processesCapacity : 1))
+    {
+        fprintf(stderr, "Error: could not allocate memory for processes info\n");
+        freeWorkload(workload);
+        return NULL;
+    }
+    workload->eventStarts[0] = 0;
+    return workload;
+}
+
+static Workload *initParsedWorkload(InputParser *parser)
+{
+    Workload *workload = initEmptyWorkload(INITIAL_PROCESSES_CAPACITY, parser->eventsCapacity);
+    if (workload)
+    {
+        parser->processesCapacity = INITIAL_PROCESSES_CAPACITY;
+    }
+    return workload;
+}
+
+static int skipInputBlankLines(InputParser *parser)
+{
+    while (true)
+    {
+        skipInputSpaces(parser);
+        int c = peekInputChar(parser);
+        if (c == '#')
+        {
+            skipInputLine(parser);
+        }
+        else if (c == '\n')
+        {
+            readInputChar(parser);
+        }
+        else
+        {
+            return c;
+        }
+    }
+}
+
+static bool parseInputLines(InputParser *parser, Workload *workload)
+{
+    // 1 line == 1 process
+    while (skipInputBlankLines(parser) != EOF)
+    {
+        if (!parseInputProcess(parser, workload))
+        {
+            return false;
+        }
+    } // End of file
+
+    if (parser->file && ferror(parser->file))
+    {
+        fprintf(stderr, "Error: could not read file %s\n", parser->fileName);
+        return false;
+    }
+    return true;
+}
+
+static void *parseInputChunk(void *arg)
+{
+    ParseChunk *chunk = (ParseChunk *) arg;
+    chunk->workload = initParsedWorkload(&chunk->parser);
+    chunk->success = chunk->workload && parseInputLines(&chunk->parser, chunk->workload);
+    return NULL;
+}
+
+static Workload *mergeParseChunks(ParseChunk *chunks, int nbChunks)
+{
+    int64_t nbProcesses = 0;
+    int64_t nbEvents = 0;
+    for (int i = 0; i < nbChunks; i++)
+    {
+        nbProcesses += chunks[i].workload->nbProcesses;
+        nbEvents += chunks[i].workload->nbEvents;
+    }
+    if (nbProcesses > INT_MAX)
+    {
+        fprintf(stderr, "Error: too many processes in the input file\n");
+        return NULL;
+    }
+
+    Workload *workload = initEmptyWorkload((int) nbProcesses, nbEvents);
+    if (!workload)
+    {
+        return NULL;
+    }
+
+    // the chunks are concatenated in the order of the file, whatever the
+    // order in which the threads finished
+    for (int i = 0; i < nbChunks; i++)
+    {
+        const Workload *chunk = chunks[i].workload;
+        int offset = workload->nbProcesses;
+        memcpy(workload->pids + offset, chunk->pids, sizeof(int) * chunk->nbProcesses);
+        memcpy(workload->priorities + offset, chunk->priorities, sizeof(int) * chunk->nbProcesses);
+        memcpy(workload->startTimes + offset, chunk->startTimes, sizeof(int64_t) * chunk->nbProcesses);
+        memcpy(workload->processDurations + offset, chunk->processDurations, sizeof(int64_t) * chunk->nbProcesses);
+        for (int j = 0; j < chunk->nbProcesses; j++)
+        {
+            workload->eventStarts[offset + j] = workload->nbEvents + chunk->eventStarts[j];
+        }
+        memcpy(workload->events + workload->nbEvents, chunk->events, sizeof(ProcessEvent) * chunk->nbEvents);
+        workload->nbProcesses += chunk->nbProcesses;
+        workload->nbEvents += chunk->nbEvents;
+    }
+    workload->eventStarts[workload->nbProcesses] = workload->nbEvents;
+
+    return workload;
+}
+
+static bool expectInputChar(InputParser *parser, char expected)
+{
+    skipInputSpaces(parser);
+    if (peekInputChar(parser) != expected)
+    {
+        char message[32];
+        sprintf(message, "expected '%c'", expected);
+        reportParseError(parser, parser->column, message);
+        return false;
+    }
+    readInputChar(parser);
+    return true;
+}
+
+static bool parseInputInteger(InputParser *parser, int64_t minValue, int64_t maxValue, int64_t *value)
+{
+    skipInputSpaces(parser);
+    int64_t column = parser->column;
+    bool negative = peekInputChar(parser) == '-';
+    if (negative)
+    {
+        readInputChar(parser);
+    }
+    int c = peekInputChar(parser);
+    if (c < '0' || c > '9')
+    {
+        reportParseError(parser, column, "expected an integer");
+        return false;
+    }
+
+    // accumulated as a negative number to accept INT64_MIN
+    int64_t result = 0;
+    bool overflow = false;
+    while (c >= '0' && c <= '9')
+    {
+        int digit = c - '0';
+        if (result < (INT64_MIN + digit) / 10)
+        {
+            overflow = true;
+        }
+        else
+        {
+            result = result * 10 - digit;
+        }
+        parser->position++; // not a newline: same line
+        parser->column++;
+        c = peekInputChar(parser);
+    }
+    if (!negative)
+    {
+        overflow = overflow || result == INT64_MIN;
+        result = -result;
+    }
+
+    if (overflow || result < minValue || result > maxValue)
+    {
+        reportParseError(parser, column, "integer out of range");
+        return false;
+    }
+    *value = result;
+    return true;
+}
+
+static bool parseInputEvent(InputParser *parser, Workload *workload)
+{
+    if (workload->nbEvents == parser->eventsCapacity)
+    {
+        // geometric growth: amortized O(1) per event
+        ProcessEvent *events = (ProcessEvent *) realloc(workload->events,
+                sizeof(ProcessEvent) * parser->eventsCapacity * 2);
+        if (!events)
+        {
+            fprintf(stderr, "Error: could not allocate memory for event\n");
+            return false;
+        }
+        workload->events = events;
+        parser->eventsCapacity *= 2;
+    }
+    ProcessEvent *event = &workload->events[workload->nbEvents];
+
+    // the events are inside the process, parsed before them
+    if (!expectInputChar(parser, '(')
+        || !parseInputInteger(parser, 0, workload->processDurations[workload->nbProcesses] - 1, &event->time)
+        || !expectInputChar(parser, ','))
+    {
+        return false;
+    }
+
+    skipInputSpaces(parser);
+    int64_t column = parser->column;
+    char type[MAX_EVENT_TYPE_LENGTH + 1];
+    int typeLength = 0;
+    int c = peekInputChar(parser);
+    while (typeLength < MAX_EVENT_TYPE_LENGTH && ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')))
+    {
+        type[typeLength++] = (char) readInputChar(parser);
+        c = peekInputChar(parser);
+    }
+    type[typeLength] = '\0';
+    if (strcmp(type, "CPU") == 0)
+    {
+        event->type = CPU_BURST;
+    }
+    else if (strcmp(type, "IO") == 0)
+    {
+        event->type = IO_BURST;
+    }
+    else
+    {
+        reportParseError(parser, column, "expected CPU or IO");
+        return false;
+    }
+    //the scheduler switches between the CPU and the disk at the end of each burst
+    if (workload->nbEvents > workload->eventStarts[workload->nbProcesses]
+        && workload->events[workload->nbEvents - 1].type == event->type)
+    {
+        reportParseError(parser, column, "expected the CPU and IO bursts to alternate");
+        return false;
+    }
+
+    if (!expectInputChar(parser, ')'))
+    {
+        return false;
+    }
+    workload->nbEvents++;
+    return true;
+}
+
+static bool parseInputProcess(InputParser *parser, Workload *workload)
+{
+    int index = workload->nbProcesses;
+    if (index == parser->processesCapacity)
+    {
+        if (index > INT_MAX / 2 || !growWorkloadProcesses(workload, index * 2))
+        {
+            fprintf(stderr, "Error: could not allocate memory for processes info\n");
+            return false;
+        }
+        parser->processesCapacity = index * 2;
+    }
+
+    int64_t pid, priority;
+    if (!parseInputInteger(parser, INT_MIN, INT_MAX, &pid)
+        || !expectInputChar(parser, ',')
+        || !parseInputInteger(parser, 0, INT64_MAX, &workload->startTimes[index])
+        || !expectInputChar(parser, ',')
+        || !parseInputInteger(parser, 0, INT64_MAX, &workload->processDurations[index])
+        || !expectInputChar(parser, ',')
+        || !parseInputInteger(parser, INT_MIN, INT_MAX, &priority)
+        || !expectInputChar(parser, ',')
+        || !expectInputChar(parser, '['))
+    {
+        return false;
+    }
+    workload->pids[index] = (int) pid;
+    workload->priorities[index] = (int) priority;
+
+    // Read events
+    skipInputSpaces(parser);
+    if (peekInputChar(parser) != ']')
+    {
+        while (true)
+        {
+            if (!parseInputEvent(parser, workload))
+            {
+                return false;
+            }
+            skipInputSpaces(parser);
+            if (peekInputChar(parser) != ',')
+            {
+                break;
+            }
+            readInputChar(parser);
+        }
+    }
+    if (!expectInputChar(parser, ']'))
+    {
+        return false;
+    }
+
+    skipInputSpaces(parser);
+    int c = peekInputChar(parser);
+    if (c != '\n' && c != EOF)
+    {
+        reportParseError(parser, parser->column, "expected the end of the line after the events");
+        return false;
+    }
+
+    workload->nbProcesses++;
+    workload->eventStarts[workload->nbProcesses] = workload->nbEvents;
+    return true;
+}
+
+static bool growWorkloadProcesses(Workload *workload, int capacity)
+{
+    int *pids = (int *) realloc(workload->pids, sizeof(int) * capacity);
+    if (pids)
+        workload->pids = pids;
+    int *priorities = (int *) realloc(workload->priorities, sizeof(int) * capacity);
+    if (priorities)
+        workload->priorities = priorities;
+    int64_t *startTimes = (int64_t *) realloc(workload->startTimes, sizeof(int64_t) * capacity);
+    if (startTimes)
+        workload->startTimes = startTimes;
+    int64_t *processDurations = (int64_t *) realloc(workload->processDurations, sizeof(int64_t) * capacity);
+    if (processDurations)
+        workload->processDurations = processDurations;
+    int64_t *eventStarts = (int64_t *) realloc(workload->eventStarts, sizeof(int64_t) * (capacity + 1));
+    if (eventStarts)
+        workload->eventStarts = eventStarts;
+
+    return pids && priorities && startTimes && processDurations && eventStarts;
+}
+
+
+/* -------------------------- init/free functions -------------------------- */
+
+void setDefaultSimulationOptions(SimulationOptions *options)
+{
+    options->eventDriven = false;
+    options->maxTime = NO_LIMIT;
+    options->maxWallTime = NO_LIMIT;
+    options->maxStallTime = DEFAULT_MAX_STALL_TIME;
+    options->seed = DEFAULT_SEED;
+    options->stream = false;
+    options->perCoreQueues = false;
+    options->stopWarning = NULL;
+}
+
+bool parseSimulationOption(const char *arg, SimulationOptions *options, bool *valid)
+{
+    int64_t value;
+    *valid = true;
+    if (strcmp(arg, "--event-driven") == 0)
+    {
+        options->eventDriven = true;
+        return true;
+    }
+    if (strncmp(arg, "--max-time=", 11) == 0)
+    {
+        *valid = parseOptionValue(arg + 11, 0, INT64_MAX, &value);
+        if (*valid)
+            options->maxTime = value;
+        return true;
+    }
+    if (strncmp(arg, "--max-stall-time=", 17) == 0)
+    {
+        //bounded to add it to a time without overflow
+        *valid = parseOptionValue(arg + 17, 0, INT64_MAX / 2, &value);
+        if (*valid)
+            options->maxStallTime = value;
+        return true;
+    }
+    if (strncmp(arg, "--max-wall-time=", 16) == 0)
+    {
+        char *end;
+        errno = 0;
+        double seconds = strtod(arg + 16, &end);
+        // rejects NaN, the infinities and the overflows as well
+        *valid = end != arg + 16 && *end == '\0' && errno == 0 && seconds >= 0 && seconds <= DBL_MAX;
+        if (*valid)
+            options->maxWallTime = seconds;
+        return true;
+    }
+    if (strncmp(arg, "--seed=", 7) == 0)
+    {
+        *valid = parseOptionValue(arg + 7, 0, UINT_MAX, &value);
+        if (*valid)
+            options->seed = (unsigned int) value;
+        return true;
+    }
+    if (strcmp(arg, "--stream") == 0)
+    {
+        options->stream = true;
+        return true;
+    }
+    if (strcmp(arg, "--per-core-queues") == 0)
+    {
+        options->perCoreQueues = true;
+        return true;
+    }
+    return false;
+}
+
+Workload *parseInputFile(const char *fileName)
+{
+    return parseInputFileWithThreads(fileName, getOnlineCoreCount());
+}
+
+Workload *parseInputFileWithThreads(const char *fileName, int nbThreads)
+{
+    printVerbose("Parsing input file...\n");
+    InputParser parser;
+    if (!openInputParser(&parser, fileName, true))
+    {
+        return NULL;
+    }
+
+    // a mapped file is split in chunks starting at the beginning of a line,
+    // parsed in parallel (a file read by blocks is parsed by a single thread)
+    int nbChunks = 1;
+    if (!parser.file && nbThreads > 1)
+    {
+        nbChunks = (int) min64(nbThreads, (int64_t) (parser.length / PARALLEL_PARSE_MIN_BYTES));
+        nbChunks = nbChunks < 1 ? 1 : nbChunks;
+    }
+    ParseChunk *chunks = (ParseChunk *) malloc(nbChunks * sizeof(ParseChunk));
+    pthread_t *threads = (pthread_t *) malloc(nbChunks * sizeof(pthread_t));
+    bool *threadStarted = (bool *) calloc(nbChunks, sizeof(bool));
+    if (!chunks || !threads || !threadStarted)
+    {
+        fprintf(stderr, "Error: could not allocate memory to parse the input file\n");
+        free(chunks);
+        free(threads);
+        free(threadStarted);
+        closeInputParser(&parser);
+        return NULL;
+    }
+    size_t chunkStart = 0;
+    for (int i = 0; i < nbChunks; i++)
+    {
+        size_t chunkEnd = parser.length;
+        if (i < nbChunks - 1)
+        {
+            // first line starting after the even split
+            chunkEnd = parser.length / nbChunks * (i + 1);
+            chunkEnd = chunkEnd < chunkStart ? chunkStart : chunkEnd;
+            const char *newline = (const char *) memchr(parser.buffer + chunkEnd, '\n', parser.length - chunkEnd);
+            chunkEnd = newline ? (size_t) (newline - parser.buffer) + 1 : parser.length;
+        }
+        chunks[i].parser = parser;
+        chunks[i].parser.buffer += chunkStart;
+        chunks[i].parser.length = chunkEnd - chunkStart;
+        chunks[i].workload = NULL;
+        chunks[i].success = false;
+        chunkStart = chunkEnd;
+    }
+
+    for (int i = 1; i < nbChunks; i++)
+    {
+        threadStarted[i] = pthread_create(&threads[i], NULL, parseInputChunk, &chunks[i]) == 0;
+    }
+    parseInputChunk(&chunks[0]);
+    for (int i = 1; i < nbChunks; i++)
+    {
+        if (threadStarted[i])
+            pthread_join(threads[i], NULL);
+        else
+            parseInputChunk(&chunks[i]); // no thread available: parsed here
+    }
+
+    // the first error in the order of the file is reported, with its line in the whole file
+    bool success = true;
+    int64_t lineOffset = 0;
+    for (int i = 0; i < nbChunks && success; i++)
+    {
+        success = chunks[i].success;
+        if (!success && chunks[i].parser.hasError)
+        {
+            printParseError(&chunks[i].parser, lineOffset);
+        }
+        lineOffset += chunks[i].parser.line - 1;
+    }
+    closeInputParser(&parser);
+
+    Workload *workload = NULL;
+    if (success)
+    {
+        workload = nbChunks == 1 ? chunks[0].workload : mergeParseChunks(chunks, nbChunks);
+    }
+    for (int i = 0; i < nbChunks; i++)
+    {
+        if (chunks[i].workload && chunks[i].workload != workload)
+            freeWorkload(chunks[i].workload);
+    }
+    free(chunks);
+    free(threads);
+    free(threadStarted);
+
+    if (!workload)
+    {
+        return NULL;
+    }
+    workload->eventEnds = workload->eventStarts + 1;
+    if (!buildPIDIndex(workload) || !buildArrivalOrder(workload))
+    {
+        freeWorkload(workload);
+        return NULL;
+    }
+
+    printVerbose("Input file parsed successfully\n");
+
+    return workload;
+}
+
+Workload *loadWorkload(const char *fileName)
+{
+    // only a regular file can be read twice: a pipe or a FIFO is always a text input file
+    struct stat fileStat;
+    if (stat(fileName, &fileStat) == 0 && !S_ISREG(fileStat.st_mode))
+        return parseInputFile(fileName);
+
+    FILE *file = fopen(fileName, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "Error: could not open file %s\n", fileName);
+        return NULL;
+    }
+    char magic[BINARY_WORKLOAD_MAGIC_SIZE];
+    bool binary = fread(magic, 1, BINARY_WORKLOAD_MAGIC_SIZE, file) == BINARY_WORKLOAD_MAGIC_SIZE
+                  && memcmp(magic, BINARY_WORKLOAD_MAGIC, BINARY_WORKLOAD_MAGIC_SIZE) == 0;
+    fclose(file);
+
+    return binary ? loadBinaryWorkload(fileName) : parseInputFile(fileName);
+}
+
+bool saveBinaryWorkload(const Workload *workload, const char *fileName)
+{
+    FILE *file = fopen(fileName, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Error: could not create file %s\n", fileName);
+        return false;
+    }
+
+    uint64_t nbProcesses = (uint64_t) workload->nbProcesses;
+    uint64_t processTableOffset = BINARY_HEADER_SIZE;
+    uint64_t burstTableOffset = processTableOffset + getBinaryProcessTableSize(nbProcesses);
+
+    // header
+    bool success = fwrite(BINARY_WORKLOAD_MAGIC, 1, BINARY_WORKLOAD_MAGIC_SIZE, file) == BINARY_WORKLOAD_MAGIC_SIZE
+                   && writeLittleEndian(file, BINARY_WORKLOAD_VERSION, 4)
+                   && writeLittleEndian(file, BINARY_HEADER_SIZE, 4)
+                   && writeLittleEndian(file, nbProcesses, 8)
+                   && writeLittleEndian(file, (uint64_t) workload->nbEvents, 8)
+                   && writeLittleEndian(file, processTableOffset, 8)
+                   && writeLittleEndian(file, burstTableOffset, 8);
+    for (int i = 48; success && i < BINARY_HEADER_SIZE; i += 8)
+    {
+        success = writeLittleEndian(file, 0, 8); // reserved
+    }
+
+    // process table, one column after the other (8-byte columns first to keep them aligned)
+    for (uint64_t i = 0; success && i < nbProcesses; i++)
+        success = writeLittleEndian(file, (uint64_t) workload->startTimes[i], 8);
+    for (uint64_t i = 0; success && i < nbProcesses; i++)
+        success = writeLittleEndian(file, (uint64_t) workload->processDurations[i], 8);
+    for (uint64_t i = 0; success && i <= nbProcesses; i++)
+        success = writeLittleEndian(file, (uint64_t) workload->eventStarts[i], 8);
+    for (uint64_t i = 0; success && i < nbProcesses; i++)
+        success = writeLittleEndian(file, (uint32_t) workload->pids[i], 4);
+    for (uint64_t i = 0; success && i < nbProcesses; i++)
+        success = writeLittleEndian(file, (uint32_t) workload->priorities[i], 4);
+    for (uint64_t i = 0; success && i < nbProcesses; i++)
+        success = writeLittleEndian(file, (uint32_t) workload->arrivalOrder[i], 4);
+    if (success && (3 * nbProcesses) % 2 == 1)
+        success = writeLittleEndian(file, 0, 4); // padding to 8 bytes
+
+    // burst table
+    for (int64_t i = 0; success && i < workload->nbEvents; i++)
+    {
+        success = writeLittleEndian(file, (uint64_t) workload->events[i].time, 8)
+                  && writeLittleEndian(file, (uint32_t) workload->events[i].type, 4)
+                  && writeLittleEndian(file, 0, 4); // reserved
+    }
+
+    if (fclose(file) != 0 || !success)
+    {
+        fprintf(stderr, "Error: could not write file %s\n", fileName);
+        return false;
+    }
+    return true;
+}
+
+Workload *loadBinaryWorkload(const char *fileName)
+{
+    // the tables are used in place: the layout of the file must be the layout in memory
+    const uint16_t one = 1;
+    if (*(const unsigned char *) &one != 1 || sizeof(int) != 4
+        || sizeof(ProcessEvent) != BINARY_EVENT_SIZE || offsetof(ProcessEvent, type) != 8)
+    {
+        fprintf(stderr, "Error: binary workload files are not supported on this platform\n");
+        return NULL;
+    }
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd == -1)
+    {
+        fprintf(stderr, "Error: could not open file %s\n", fileName);
+        return NULL;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < BINARY_HEADER_SIZE || (uintmax_t) fileStat.st_size > SIZE_MAX)
+    {
+        fprintf(stderr, "Error: %s is not a binary workload file\n", fileName);
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t) fileStat.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid
+    if (mapping == MAP_FAILED)
+    {
+        fprintf(stderr, "Error: could not map file %s\n", fileName);
+        return NULL;
+    }
+
+    const unsigned char *header = (const unsigned char *) mapping;
+    uint64_t version = readLittleEndian(header + 8, 4);
+    uint64_t headerSize = readLittleEndian(header + 12, 4);
+    uint64_t nbProcesses = readLittleEndian(header + 16, 8);
+    uint64_t nbEvents = readLittleEndian(header + 24, 8);
+    uint64_t processTableOffset = readLittleEndian(header + 32, 8);
+    uint64_t burstTableOffset = readLittleEndian(header + 40, 8);
+    const char *error = NULL;
+    if (memcmp(header, BINARY_WORKLOAD_MAGIC, BINARY_WORKLOAD_MAGIC_SIZE) != 0)
+        error = "not a binary workload file";
+    else if (version != BINARY_WORKLOAD_VERSION)
+        error = "unsupported version";
+    else if (headerSize != BINARY_HEADER_SIZE || nbProcesses > INT_MAX
+             || nbEvents > (uint64_t) size / BINARY_EVENT_SIZE
+             || processTableOffset % 8 != 0 || burstTableOffset % 8 != 0
+             || processTableOffset < headerSize || processTableOffset > size
+             || getBinaryProcessTableSize(nbProcesses) > size - processTableOffset
+             || burstTableOffset < processTableOffset + getBinaryProcessTableSize(nbProcesses)
+             || burstTableOffset > size
+             || nbEvents * BINARY_EVENT_SIZE > size - burstTableOffset)
+        error = "invalid table sizes";
+    if (error)
+    {
+        fprintf(stderr, "Error: %s: %s\n", fileName, error);
+        munmap(mapping, size);
+        return NULL;
+    }
+
+    Workload *workload = (Workload *) malloc(sizeof(Workload));
+    if (!workload)
+    {
+        fprintf(stderr, "Error: could not allocate memory for workload\n");
+        munmap(mapping, size);
+        return NULL;
+    }
+    char *processTable = (char *) mapping + processTableOffset;
+    workload->nbProcesses = (int) nbProcesses;
+    workload->startTimes = (int64_t *) processTable;
+    workload->processDurations = workload->startTimes + nbProcesses;
+    workload->eventStarts = workload->processDurations + nbProcesses;
+    workload->eventEnds = workload->eventStarts + 1;
+    workload->pids = (int *) (workload->eventStarts + nbProcesses + 1);
+    workload->priorities = workload->pids + nbProcesses;
+    workload->arrivalOrder = workload->priorities + nbProcesses;
+    workload->events = (ProcessEvent *) ((char *) mapping + burstTableOffset);
+    workload->nbEvents = (int64_t) nbEvents;
+    workload->pidIndexKeys = NULL;
+    workload->pidIndex = NULL;
+    workload->mapping = mapping;
+    workload->mappingSize = size;
+
+    if (!checkBinaryWorkload(workload))
+    {
+        fprintf(stderr, "Error: %s: inconsistent process table\n", fileName);
+        freeWorkload(workload);
+        return NULL;
+    }
+    if (!buildPIDIndex(workload))
+    {
+        freeWorkload(workload);
+        return NULL;
+    }
+
+    return workload;
 }
 
-int getProcessStartTime(Workload *workload, int pid)
+void freeWorkload(Workload *workload)
 {
-    for (int i = 0; i < workload->nbProcesses; i++)
+    if (workload->mapping)
     {
-        if (getPIDFromWorkload(workload, i) == pid)
-        {
-            return workload->processesInfo[i]->startTime;
-        }
+        munmap(workload->mapping, workload->mappingSize);
     }
-    return -1;
-}
-
-int getProcessDuration(Workload *workload, int pid)
-{
-    for (int i = 0; i < workload->nbProcesses; i++)
+    else
     {
-        if (getPIDFromWorkload(workload, i) == pid)
-        {
-            return workload->processesInfo[i]->processDuration;
-        }
+        free(workload->pids);
+        free(workload->priorities);
+        free(workload->startTimes);
+        free(workload->processDurations);
+        free(workload->eventStarts);
+        free(workload->events);
+        free(workload->arrivalOrder);
     }
-    return -1;
+    free(workload->pidIndexKeys);
+    free(workload->pidIndex);
+    free(workload);
 }
 
-int getProcessAdvancementTime(Workload *workload, int pid)
+SimulationState *initSimulationState(const Workload *workload)
 {
-    for (int i = 0; i < workload->nbProcesses; i++)
+    SimulationState *state = (SimulationState *) malloc(sizeof(SimulationState));
+    if (!state)
     {
-        if (getPIDFromWorkload(workload, i) == pid)
-        {
-            return workload->processesInfo[i]->advancementTime;
-        }
+        fprintf(stderr, "Error: could not allocate memory for simulation state\n");
+        return NULL;
+    }
+    state->workload = workload;
+    state->processBlocks = NULL;
+    state->nbProcessBlocks = 0;
+    state->advancementTimes = (int64_t *) malloc(sizeof(int64_t) * workload->nbProcesses);
+    state->nextEvents = (int64_t *) malloc(sizeof(int64_t) * workload->nbProcesses);
+    state->activeProcesses = (int *) malloc(sizeof(int) * workload->nbProcesses);
+    state->stream = NULL;
+    if (!growStateProcesses(state, workload->nbProcesses) || !state->advancementTimes || !state->nextEvents
+        || !state->activeProcesses)
+    {
+        fprintf(stderr, "Error: could not allocate memory for simulation state\n");
+        freeSimulationState(state);
+        return NULL;
     }
-    return -1;
+
+    resetSimulationState(state);
+    return state;
 }
 
-int getProcessNextEventTime(Workload *workload, int pid)
+void resetSimulationState(SimulationState *state)
 {
-    int processNextEventTime = getProcessDuration(workload, pid); // relative to the process
+    const Workload *workload = state->workload;
     for (int i = 0; i < workload->nbProcesses; i++)
     {
-        if (getPIDFromWorkload(workload, i) != pid)
-        {
-            continue;
-        }
-        if (workload->processesInfo[i]->nextEvent)
-        {
-            processNextEventTime = workload->processesInfo[i]->nextEvent->time;
-        }
-        break;
+        PCB *pcb = getPCBFromState(state, i);
+        pcb->pid = workload->pids[i];
+        pcb->state = READY;
+        pcb->priority = workload->priorities[i];
+        initNode(getNodeFromState(state, i), pcb); //out of the queues until its arrival
+        state->advancementTimes[i] = 0;
+        state->nextEvents[i] = workload->eventStarts[i];
     }
-    return processNextEventTime;
+    state->nextArrival = 0;
+    state->nbActiveProcesses = 0;
 }
 
-int getProcessCurEventTimeLeft(Workload *workload, int pid)
+void freeSimulationState(SimulationState *state)
 {
-    return getProcessNextEventTime(workload, pid)
-           - getProcessAdvancementTime(workload, pid);
-}
-
-static int getProcessIndex(Workload *workload, int pid)
-{
-    int processIndex = 0;
-    for (; processIndex < workload->nbProcesses; processIndex++)
+    for (int i = 0; i < state->nbProcessBlocks; i++)
     {
-        if (getPIDFromWorkload(workload, processIndex) != pid)
-        {
-            continue;
-        }
-        break;
+        free(state->processBlocks[i]);
     }
-
-    return processIndex;
+    free(state->processBlocks);
+    free(state->advancementTimes);
+    free(state->nextEvents);
+    free(state->activeProcesses);
+    if (state->stream)
+    {
+        freeProcessStream(state->stream);
+    }
+    free(state);
 }
 
-static void setProcessAdvancementTime(Workload *workload, int pid, int advancementTime)
+static bool growStateProcesses(SimulationState *state, int nbProcesses)
 {
-    for (int i = 0; i < workload->nbProcesses; i++)
+    int nbBlocks = (int) (((int64_t) nbProcesses + PROCESS_BLOCK_SIZE - 1) / PROCESS_BLOCK_SIZE);
+    if (nbBlocks <= state->nbProcessBlocks)
+    {
+        return true;
+    }
+    ProcessRecord **processBlocks = (ProcessRecord **) realloc(state->processBlocks, sizeof(ProcessRecord *) * nbBlocks);
+    if (!processBlocks)
     {
-        if (getPIDFromWorkload(workload, i) == pid)
+        return false;
+    }
+    state->processBlocks = processBlocks;
+    while (state->nbProcessBlocks < nbBlocks)
+    {
+        state->processBlocks[state->nbProcessBlocks] = (ProcessRecord *) malloc(sizeof(ProcessRecord) * PROCESS_BLOCK_SIZE);
+        if (!state->processBlocks[state->nbProcessBlocks])
         {
-            workload->processesInfo[i]->advancementTime = advancementTime;
-            return;
+            return false;
         }
+        state->nbProcessBlocks++;
     }
+    return true;
 }
 
-static PCB *getPCBFromWorkload(Workload *workload, int index)
-{
-    return workload->processesInfo[index]->pcb;
-}
 
-/* -------------------------- init/free functions -------------------------- */
+/* --------------------------- streamed simulation -------------------------- */
 
-Workload *parseInputFile(const char *fileName)
+static SimulationState *initStreamedSimulationState(const char *fileName, AllStats *stats)
 {
-    printVerbose("Parsing input file...\n");
-    FILE *file = fopen(fileName, "r");
-    if (!file)
+    SimulationState *state = (SimulationState *) malloc(sizeof(SimulationState));
+    ProcessStream *stream = (ProcessStream *) malloc(sizeof(ProcessStream));
+    if (!state || !stream)
     {
-        fprintf(stderr, "Error: could not open file %s\n", fileName);
+        fprintf(stderr, "Error: could not allocate memory for simulation state\n");
+        free(state);
+        free(stream);
+        return NULL;
+    }
+    if (!openInputParser(&stream->parser, fileName, false))
+    {
+        free(state);
+        free(stream);
+        return NULL;
+    }
+    stream->window = initEmptyWorkload(INITIAL_PROCESSES_CAPACITY, INITIAL_EVENTS_CAPACITY);
+    stream->scratch = initParsedWorkload(&stream->parser);
+    stream->capacity = 0;
+    stream->eventsCapacity = INITIAL_EVENTS_CAPACITY;
+    stream->nbLiveEvents = 0;
+    stream->used = NULL;
+    stream->freeIndexes = NULL;
+    stream->nbFreeIndexes = 0;
+    stream->nbActive = 0;
+    stream->nextArrival = NO_INDEX;
+    stream->lastStartTime = 0;
+    stream->failed = false;
+
+    state->workload = stream->window;
+    state->processBlocks = NULL;
+    state->nbProcessBlocks = 0;
+    state->advancementTimes = NULL;
+    state->nextEvents = NULL;
+    state->nextArrival = 0;
+    state->activeProcesses = NULL;
+    state->nbActiveProcesses = 0;
+    state->stream = stream;
+    if (!stream->window || !stream->scratch)
+    {
+        freeSimulationState(state);
         return NULL;
     }
 
-    Workload *workload = (Workload *) malloc(sizeof(Workload));
-    if (!workload)
+    // the window has no arrival order and a hashed PID index updated as the
+    // processes come and go
+    Workload *window = stream->window;
+    window->densePIDIndex = false;
+    window->minPID = 0;
+    window->pidIndexSize = 2 * INITIAL_PROCESSES_CAPACITY;
+    window->pidIndexKeys = (int *) malloc(window->pidIndexSize * sizeof(int));
+    window->pidIndex = (int *) malloc(window->pidIndexSize * sizeof(int));
+    if (!window->pidIndexKeys || !window->pidIndex)
     {
-        fprintf(stderr, "Error: could not allocate memory for workload\n");
-        fclose(file);
+        fprintf(stderr, "Error: could not allocate memory for the PID index\n");
+        freeSimulationState(state);
+        return NULL;
+    }
+    for (int i = 0; i < window->pidIndexSize; i++)
+    {
+        window->pidIndex[i] = NO_INDEX;
+    }
+    if (!growStreamWindow(state, stats))
+    {
+        freeSimulationState(state);
         return NULL;
     }
 
-    char line[MAX_CHAR_PER_LINE];
-    int nbProcesses = 0;
-    // 1 line == 1 process
-    while (fgets(line, MAX_CHAR_PER_LINE, file))
+    readStreamedProcess(state, stats);
+    if (stream->failed)
     {
-        if (line[strlen(line) - 1] != '\n')
-        {
-            fprintf(stderr, "Error: line too long in the input file.\n");
-            freeWorkload(workload);
-            fclose(file);
-            return NULL;
-        }
-        if (line[0] == '#' || line[0] == '\n')
-        {
-            continue;
-        }
-        nbProcesses++;
+        freeSimulationState(state);
+        return NULL;
+    }
+    return state;
+}
+
+static bool growStreamWindow(SimulationState *state, AllStats *stats)
+{
+    ProcessStream *stream = state->stream;
+    Workload *window = stream->window;
+    if (stream->capacity > INT_MAX / 2)
+    {
+        fprintf(stderr, "Error: too many processes running at the same time\n");
+        return false;
     }
-    
-    workload->processesInfo = (ProcessSimulationInfo **) malloc(
-            sizeof(ProcessSimulationInfo *) * nbProcesses);
-    if (!workload->processesInfo)
+    int capacity = stream->capacity == 0 ? INITIAL_PROCESSES_CAPACITY : stream->capacity * 2;
+
+    bool success = growWorkloadProcesses(window, capacity) && growStateProcesses(state, capacity);
+    int64_t *eventEnds = (int64_t *) realloc(window->eventEnds, sizeof(int64_t) * capacity);
+    if (eventEnds)
+        window->eventEnds = eventEnds;
+    int64_t *advancementTimes = (int64_t *) realloc(state->advancementTimes, sizeof(int64_t) * capacity);
+    if (advancementTimes)
+        state->advancementTimes = advancementTimes;
+    int64_t *nextEvents = (int64_t *) realloc(state->nextEvents, sizeof(int64_t) * capacity);
+    if (nextEvents)
+        state->nextEvents = nextEvents;
+    int *activeProcesses = (int *) realloc(state->activeProcesses, sizeof(int) * capacity);
+    if (activeProcesses)
+        state->activeProcesses = activeProcesses;
+    bool *used = (bool *) realloc(stream->used, sizeof(bool) * capacity);
+    if (used)
+        stream->used = used;
+    int *freeIndexes = (int *) realloc(stream->freeIndexes, sizeof(int) * capacity);
+    if (freeIndexes)
+        stream->freeIndexes = freeIndexes;
+    if (!success || !eventEnds || !advancementTimes || !nextEvents || !activeProcesses || !used || !freeIndexes)
     {
         fprintf(stderr, "Error: could not allocate memory for processes info\n");
-        freeWorkload(workload);
-        fclose(file);
-        return NULL;
+        return false;
     }
 
-    workload->nbProcesses = 0;
+    for (int i = stream->capacity; i < capacity; i++)
+    {
+        stream->used[i] = false;
+    }
+    stream->capacity = capacity;
+    // the stats of the processes in the window only
+    setNbProcessesInStats(stats, capacity);
+    return true;
+}
+
+static bool reserveStreamEvents(SimulationState *state, int64_t nbEvents)
+{
+    ProcessStream *stream = state->stream;
+    Workload *window = stream->window;
+    if (window->nbEvents + nbEvents <= stream->eventsCapacity)
+    {
+        return true;
+    }
 
-    rewind(file);
-    while (fgets(line, MAX_CHAR_PER_LINE, file)) // Read file line by line
+    // the events of the processes in the window are copied to a new array,
+    // twice as large as needed: amortized O(1) per event
+    int64_t capacity = max64(2 * (stream->nbLiveEvents + nbEvents), INITIAL_EVENTS_CAPACITY);
+    ProcessEvent *events = (ProcessEvent *) malloc(sizeof(ProcessEvent) * capacity);
+    if (!events)
+    {
+        fprintf(stderr, "Error: could not allocate memory for event\n");
+        return false;
+    }
+    int64_t nbCopied = 0;
+    for (int i = 0; i < window->nbProcesses; i++)
     {
-        if (line[0] == '#' || line[0] == '\n')
+        if (!stream->used[i])
         {
             continue;
         }
+        int64_t nbProcessEvents = window->eventEnds[i] - window->eventStarts[i];
+        memcpy(events + nbCopied, window->events + window->eventStarts[i], sizeof(ProcessEvent) * nbProcessEvents);
+        state->nextEvents[i] += nbCopied - window->eventStarts[i];
+        window->eventStarts[i] = nbCopied;
+        nbCopied += nbProcessEvents;
+        window->eventEnds[i] = nbCopied;
+    }
+    free(window->events);
+    window->events = events;
+    window->nbEvents = nbCopied;
+    stream->eventsCapacity = capacity;
+    return true;
+}
 
-        ProcessSimulationInfo *processInfo = (ProcessSimulationInfo *) malloc(
-                sizeof(ProcessSimulationInfo));
-        if (!processInfo)
+static bool insertStreamedPID(ProcessStream *stream, int pid, int index)
+{
+    Workload *window = stream->window;
+    if (2 * (stream->nbActive + 1) > window->pidIndexSize)
+    {
+        // load factor <= 1/2: twice as large and the processes of the window are inserted again
+        int size = window->pidIndexSize * 2;
+        int *pidIndexKeys = (int *) malloc(size * sizeof(int));
+        int *pidIndex = (int *) malloc(size * sizeof(int));
+        if (!pidIndexKeys || !pidIndex)
         {
-            fprintf(stderr, "Error: could not allocate memory for process info\n");
-            freeWorkload(workload);
-            fclose(file);
-            return NULL;
+            fprintf(stderr, "Error: could not allocate memory for the PID index\n");
+            free(pidIndexKeys);
+            free(pidIndex);
+            return false;
         }
-
-        processInfo->pcb = (PCB *) malloc(sizeof(PCB));
-        if (!processInfo->pcb)
+        free(window->pidIndexKeys);
+        free(window->pidIndex);
+        window->pidIndexKeys = pidIndexKeys;
+        window->pidIndex = pidIndex;
+        window->pidIndexSize = size;
+        for (int i = 0; i < size; i++)
         {
-            fprintf(stderr, "Error: could not allocate memory for PCB\n");
-            free(processInfo);
-            freeWorkload(workload);
-            fclose(file);
-            return NULL;
+            window->pidIndex[i] = NO_INDEX;
         }
-
-        processInfo->pcb->state = READY;
-
-        char *token = strtok(line, ",");
-        processInfo->pcb->pid = atoi(token);
-
-        token = strtok(NULL, ",");
-        processInfo->startTime = atoi(token);
-
-        token = strtok(NULL, ",");
-        processInfo->processDuration = atoi(token);
-
-        token = strtok(NULL, ",");
-        processInfo->pcb->priority = atoi(token);
-
-        processInfo->advancementTime = 0;
-
-        token = strtok(NULL, "(");
-
-        ProcessEvent *event = NULL;
-        while (strstr(token, ",") || strstr(token, "[")) // Read events
+        for (int i = 0; i < window->nbProcesses; i++)
         {
-            if (strstr(token, "[")) // first event
-            {
-                event = (ProcessEvent *) malloc(sizeof(ProcessEvent));
-                processInfo->nextEvent = event;
-            }
-            else
-            {
-                event->nextEvent = (ProcessEvent *) malloc(sizeof(ProcessEvent));
-                event = event->nextEvent;
-            }
-            if (!event)
+            if (stream->used[i])
             {
-                fprintf(stderr, "Error: could not allocate memory for event\n");
-                free(processInfo->pcb);
-                free(processInfo);
-                freeWorkload(workload);
-                fclose(file);
-                return NULL;
+                int slot = getPIDIndexSlot(window, window->pids[i]);
+                window->pidIndexKeys[slot] = window->pids[i];
+                window->pidIndex[slot] = i;
             }
+        }
+    }
 
-            token = strtok(NULL, ",");
-            event->time = atoi(token);
+    int slot = getPIDIndexSlot(window, pid);
+    window->pidIndexKeys[slot] = pid;
+    window->pidIndex[slot] = index;
+    return true;
+}
 
-            token = strtok(NULL, ")");
+static void removeStreamedPID(ProcessStream *stream, int pid)
+{
+    Workload *window = stream->window;
+    unsigned int mask = (unsigned int) window->pidIndexSize - 1;
+    unsigned int hole = (unsigned int) getPIDIndexSlot(window, pid);
+
+    // backward shift deletion: the following entries of the probe sequence
+    // move back into the hole if it is on their own probe sequence
+    unsigned int next = (hole + 1) & mask;
+    while (window->pidIndex[next] != NO_INDEX)
+    {
+        unsigned int home = getPIDIndexHome(window, window->pidIndexKeys[next]);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            window->pidIndexKeys[hole] = window->pidIndexKeys[next];
+            window->pidIndex[hole] = window->pidIndex[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    window->pidIndex[hole] = NO_INDEX;
+}
 
-            if (token != NULL)
-            {
-                if (strstr(token, "CPU"))
-                {
-                    event->type = CPU_BURST;
-                }
-                else if (strstr(token, "IO"))
-                {
-                    event->type = IO_BURST;
-                }
-                else
-                {
-                    fprintf(stderr, "Error: Unknown operation type\n");
-                }
-            }
+static void readStreamedProcess(SimulationState *state, AllStats *stats)
+{
+    ProcessStream *stream = state->stream;
+    InputParser *parser = &stream->parser;
+    Workload *window = stream->window;
+    Workload *scratch = stream->scratch;
+    stream->nextArrival = NO_INDEX;
+    if (stream->failed)
+    {
+        return;
+    }
 
-            event->nextEvent = NULL;
-            token = strtok(NULL, "(");
-        } // End of events
-        workload->processesInfo[workload->nbProcesses] = processInfo;
-        workload->nbProcesses++;
-    } // End of file
+    if (skipInputBlankLines(parser) == EOF)
+    {
+        if (ferror(parser->file))
+        {
+            fprintf(stderr, "Error: could not read file %s\n", parser->fileName);
+            stream->failed = true;
+        }
+        return;
+    }
+    scratch->nbProcesses = 0;
+    scratch->nbEvents = 0;
+    if (!parseInputProcess(parser, scratch))
+    {
+        if (parser->hasError)
+        {
+            printParseError(parser, 0);
+        }
+        stream->failed = true;
+        return;
+    }
 
-    fclose(file);
+    int pid = scratch->pids[0];
+    if (scratch->startTimes[0] < stream->lastStartTime)
+    {
+        fprintf(stderr, "Error: %s:%" PRId64 ": the processes must be sorted by start time to be streamed\n",
+                parser->fileName, parser->line);
+        stream->failed = true;
+        return;
+    }
+    if (getProcessIndex(window, pid) != NO_INDEX)
+    {
+        fprintf(stderr, "Error: PID %d is used by several processes\n", pid);
+        stream->failed = true;
+        return;
+    }
+    stream->lastStartTime = scratch->startTimes[0];
 
-    printVerbose("Input file parsed successfully\n");
+    // index of a terminated process if any, otherwise a new one
+    if (stream->nbFreeIndexes == 0 && window->nbProcesses == stream->capacity
+        && !growStreamWindow(state, stats))
+    {
+        stream->failed = true;
+        return;
+    }
+    int index = stream->nbFreeIndexes > 0 ? stream->freeIndexes[--stream->nbFreeIndexes] : window->nbProcesses++;
+    if (!reserveStreamEvents(state, scratch->nbEvents) || !insertStreamedPID(stream, pid, index))
+    {
+        stream->freeIndexes[stream->nbFreeIndexes++] = index;
+        stream->failed = true;
+        return;
+    }
 
-    return workload;
+    window->pids[index] = pid;
+    window->priorities[index] = scratch->priorities[0];
+    window->startTimes[index] = scratch->startTimes[0];
+    window->processDurations[index] = scratch->processDurations[0];
+    window->eventStarts[index] = window->nbEvents;
+    memcpy(window->events + window->nbEvents, scratch->events, sizeof(ProcessEvent) * scratch->nbEvents);
+    window->nbEvents += scratch->nbEvents;
+    window->eventEnds[index] = window->nbEvents;
+    stream->nbLiveEvents += scratch->nbEvents;
+
+    PCB *pcb = getPCBFromState(state, index);
+    pcb->pid = pid;
+    pcb->state = READY;
+    pcb->priority = window->priorities[index];
+    initNode(getNodeFromState(state, index), pcb); //out of the queues until its arrival
+    state->advancementTimes[index] = 0;
+    state->nextEvents[index] = window->eventStarts[index];
+
+    stream->used[index] = true;
+    stream->nbActive++;
+    stream->nextArrival = index;
+    if (!addProcessToStats(stats, window, index))
+    {
+        stream->failed = true;
+    }
 }
 
-void freeWorkload(Workload *workload)
+static void releaseTerminatedProcesses(SimulationState *state, AllStats *stats)
 {
-    for (int i = 0; i < workload->nbProcesses; i++)
+    ProcessStream *stream = state->stream;
+    Workload *window = stream->window;
+    for (int i = 0; i < window->nbProcesses; i++)
     {
-        ProcessEvent *event = workload->processesInfo[i]->nextEvent;
-        while (event)
+        if (!stream->used[i] || getPCBFromState(state, i)->state != TERMINATED)
         {
-            ProcessEvent *nextEvent = event->nextEvent;
-            free(event);
-            event = nextEvent;
+            continue;
         }
-        free(workload->processesInfo[i]->pcb);
-        free(workload->processesInfo[i]);
+        // no node points to the PCB anymore (freed when the process terminated)
+        retireProcessStats(stats, window->pids[i]);
+        removeStreamedPID(stream, window->pids[i]);
+        stream->nbLiveEvents -= window->eventEnds[i] - window->eventStarts[i];
+        stream->used[i] = false;
+        stream->freeIndexes[stream->nbFreeIndexes++] = i;
+        stream->nbActive--;
     }
-    free(workload->processesInfo);
-    free(workload);
+}
+
+static void freeProcessStream(ProcessStream *stream)
+{
+    closeInputParser(&stream->parser);
+    if (stream->window)
+    {
+        free(stream->window->eventEnds);
+        freeWorkload(stream->window);
+    }
+    if (stream->scratch)
+    {
+        freeWorkload(stream->scratch);
+    }
+    free(stream->used);
+    free(stream->freeIndexes);
+    free(stream);
 }
 
 
 /* ---------------------------- other functions ---------------------------- */
 
-void launchSimulation(Workload *workload, SchedulingAlgorithm **algorithms, int algorithmCount, int cpuCoreCount, ProcessGraph *graph, AllStats *stats)
+bool launchSimulation(const Workload *workload, SchedulingAlgorithm **algorithms, int algorithmCount, int cpuCoreCount, ProcessGraph *graph, AllStats *stats, const SimulationOptions *options)
 {
     for (int i = 0; i < getProcessCount(workload); i++)
     {
@@ -421,11 +2370,46 @@ void launchSimulation(Workload *workload, SchedulingAlgorithm **algorithms, int
     }
     setNbProcessesInStats(stats, getProcessCount(workload));
 
-    Scheduler *scheduler = initScheduler(algorithms, algorithmCount, workload);
+    SimulationState *state = initSimulationState(workload);
+    if (!state)
+    {
+        fprintf(stderr, "Error: could not initialize simulation state\n");
+        freeSchedulingAlgorithms(algorithms, algorithmCount);
+        return false;
+    }
+
+    addAllProcessesToStats(stats, workload);
+
+    bool success = runSimulation(state, algorithms, algorithmCount, cpuCoreCount, graph, stats, options);
+    freeSimulationState(state);
+    return success;
+}
+
+bool launchStreamedSimulation(const char *fileName, SchedulingAlgorithm **algorithms, int algorithmCount, int cpuCoreCount, AllStats *stats, const SimulationOptions *options)
+{
+    SimulationState *state = initStreamedSimulationState(fileName, stats);
+    if (!state)
+    {
+        freeSchedulingAlgorithms(algorithms, algorithmCount);
+        return false;
+    }
+
+    bool success = runSimulation(state, algorithms, algorithmCount, cpuCoreCount, NULL, stats, options)
+                   && !state->stream->failed;
+    freeSimulationState(state);
+    return success;
+}
+
+static bool runSimulation(SimulationState *state, SchedulingAlgorithm **algorithms, int algorithmCount, int cpuCoreCount, ProcessGraph *graph, AllStats *stats, const SimulationOptions *options)
+{
+    if (options->stopWarning)
+        options->stopWarning[0] = '\0';
+
+    Scheduler *scheduler = initScheduler(algorithms, algorithmCount, cpuCoreCount, options->perCoreQueues, state);
     if (!scheduler)
     {
         fprintf(stderr, "Error: could not initialize scheduler\n");
-        return;
+        return false;
     }
 
     CPU *cpu = initCPU(cpuCoreCount);
@@ -433,7 +2417,7 @@ void launchSimulation(Workload *workload, SchedulingAlgorithm **algorithms, int
     {
         fprintf(stderr, "Error: could not initialize CPU\n");
         freeScheduler(scheduler);
-        return;
+        return false;
     }
 
     Disk *disk = initDisk();
@@ -442,151 +2426,247 @@ void launchSimulation(Workload *workload, SchedulingAlgorithm **algorithms, int
         fprintf(stderr, "Error: could not initialize disk\n");
         freeCPU(cpu);
         freeScheduler(scheduler);
-        return;
+        return false;
     }
 
-    Computer *computer = initComputer(scheduler, cpu, disk);
+    Computer *computer = initComputer(scheduler, cpu, disk, options->seed);
     if (!computer)
     {
         fprintf(stderr, "Error: could not initialize computer\n");
         freeDisk(disk);
         freeCPU(cpu);
         freeScheduler(scheduler);
-        return;
+        return false;
     }
 
-    addAllProcessesToStats(stats, workload);
-
-    int time = 0;
+    int64_t time = 0;
+    int64_t lastProgressTime = 0; // last time at which a process progressed (or none was in the system)
+    double wallTimeStart = getWallClockTime();
     /* Main loop of the simulation.*/
-    while (!workloadOver(workload)) // You probably want to change this condition
+    while (!workloadOver(state)) // You probably want to change this condition
     {
-        // TODO
+        //Stop when the simulated time or wall-clock time budget is exhausted (e.g. if preemptions never end)
+        if (options->maxTime != NO_LIMIT && time > options->maxTime)
+        {
+            warnSimulationStop(options, "simulated time budget reached at time %" PRId64 ", the workload is not over", time);
+            break;
+        }
+        if (options->maxWallTime != NO_LIMIT && getWallClockTime() - wallTimeStart > options->maxWallTime)
+        {
+            warnSimulationStop(options, "wall-clock time budget reached at time %" PRId64 ", the workload is not over", time);
+            break;
+        }
+        //Stop when no process progressed for too long (e.g. two processes preempting each other forever)
+        if (time - lastProgressTime > options->maxStallTime)
+        {
+            warnSimulationStop(options, "no process progressed since time %" PRId64 ", stopped at time %" PRId64 ", the workload is not over",
+                               lastProgressTime, time);
+            break;
+        }
+
         //1. Handle event(s): simulator and the scheduler check if an event is triggered at the current time unit and handle it
-        handleSimulationEvents(computer, workload, time, stats);
+        if (!handleSimulationEvents(computer, state, time, stats))
+        {
+            fprintf(stderr, "Error: simulation stopped at time %" PRId64 "\n", time);
+            freeComputer(computer);
+            return false;
+        }
 
         //2. Assign processes to resources: This is the step where the main scheduling decisions are made:
         //choosing what processes to execute next.
         assignProcessesToResources(computer);
 
-        int nextTime=time+1; //instead of step 3
+        //Streamed simulation: the memory of the processes terminated at this time unit is released
+        if (state->stream)
+        {
+            releaseTerminatedProcesses(state, stats);
+        }
+
+        //3. Find the next time at which an event can be triggered: either the next time unit or, in event-driven
+        //mode, the next arrival/burst end/timer expiry since nothing can happen in between.
+        int64_t nextTime = time + 1;
+        if (options->eventDriven)
+        {
+            int64_t nextEventTime = getNextSimulationEventTime(computer, state, time);
+            //stop at the time budget to still register its events in the graph
+            nextTime = options->maxTime == NO_LIMIT ? nextEventTime : min64(nextEventTime, max64(nextTime, options->maxTime));
+            //and at the end of the stall budget, as when advancing one time unit at a time
+            nextTime = min64(nextTime, max64(time + 1, lastProgressTime + options->maxStallTime));
+        }
 
         //4. Advance time to the next event: This is where the progression of time is simulated. The simulator
         //will update the advancement of the processes in the workload and the scheduler will update its
         //timers.
-        advanceProcessTime(time, nextTime, workload, computer, graph, stats);
+        if (advanceProcessTime(time, nextTime, state, computer, graph, stats))
+        {
+            lastProgressTime = nextTime;
+        }
         advanceSchedulingTime(time, nextTime, computer);
 
         time = nextTime;
-        
-        //Maximum iteration to avoid infinite loop for preemptiveness
-        if (time > 200)
-            break;
     }
+    recordWaitingTimes(state, scheduler, stats);
+    setLoadBalanceStats(stats, getLoadBalanceStats(scheduler));
     freeComputer(computer);
+    return true;
 }
 
 /* ---------------------------- static functions --------------------------- */
 
-static bool workloadOver(const Workload *workload)
+static void warnSimulationStop(const SimulationOptions *options, const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    if (options->stopWarning)
+    {
+        vsnprintf(options->stopWarning, MAX_STOP_WARNING, format, arguments);
+    }
+    else
+    {
+        fputs("Warning: ", stderr);
+        vfprintf(stderr, format, arguments);
+        fputc('\n', stderr);
+    }
+    va_end(arguments);
+}
+
+static bool workloadOver(const SimulationState *state)
 {
+    if (state->stream)
+    {
+        //the terminated processes are released: the window is empty once the file is read
+        return state->stream->failed || state->stream->nbActive == 0;
+    }
+
     //disk idle, cpu idle, readyqueue empty & no more next event
-    for (int i = 0; i < workload->nbProcesses; i++)
+    //(the terminated processes leave the active ones when the time advances)
+    return state->nbActiveProcesses == 0 && state->nextArrival == state->workload->nbProcesses;
+}
+
+static void freeSchedulingAlgorithms(SchedulingAlgorithm **algorithms, int algorithmCount)
+{
+    for (int i = 0; i < algorithmCount; i++)
     {
-        //if (workload->processesInfo[i]->advancementTime < workload->processesInfo[i]->processDuration)
-        if (workload->processesInfo[i]->pcb->state != TERMINATED)
-        {
-            return 0;
-        }
+        freeSchedulingAlgorithm(algorithms[i]);
     }
+    free(algorithms);
+}
 
-    return 1;
+static void recordWaitingTimes(SimulationState *state, Scheduler *scheduler, AllStats *stats)
+{
+    const Workload *workload = state->workload;
+    for (int i = 0; i < workload->nbProcesses; i++)
+    {
+        if ((state->stream && !state->stream->used[i]) || getPCBFromState(state, i)->state == TERMINATED)
+            continue;
+        getProcessStats(stats, getPIDFromWorkload(workload, i))->waitingTime = getProcessWaitingTime(scheduler, getNodeFromState(state, i));
+    }
 }
 
-static void addAllProcessesToStats(AllStats *stats, Workload *workload)
+static void addAllProcessesToStats(AllStats *stats, const Workload *workload)
 {
     for (int i = 0; i < workload->nbProcesses; i++)
     {
-        ProcessStats *processStats = (ProcessStats *) malloc(sizeof(ProcessStats));
-        if (!processStats)
+        if (!addProcessToStats(stats, workload, i))
         {
-            fprintf(stderr, "Error: could not allocate memory for process stats\n");
             return;
         }
-        processStats->processId = getPIDFromWorkload(workload, i);
-        processStats->priority = workload->processesInfo[i]->pcb->priority;
-        processStats->arrivalTime = 0;
-        processStats->finishTime = 0;
-        processStats->turnaroundTime = 0;
-        processStats->cpuTime = 0;
-        processStats->waitingTime = 0;
-        processStats->meanResponseTime = 0;
-        // You could want to put this field to -1
-        processStats->nbContextSwitches = 0;
+    }
+}
 
-        addProcessStats(stats, processStats);
+static bool addProcessToStats(AllStats *stats, const Workload *workload, int index)
+{
+    ProcessStats *processStats = (ProcessStats *) malloc(sizeof(ProcessStats));
+    if (!processStats)
+    {
+        fprintf(stderr, "Error: could not allocate memory for process stats\n");
+        return false;
     }
+    processStats->processId = getPIDFromWorkload(workload, index);
+    processStats->priority = workload->priorities[index];
+    processStats->arrivalTime = 0;
+    processStats->finishTime = 0;
+    processStats->turnaroundTime = 0;
+    processStats->cpuTime = 0;
+    processStats->waitingTime = 0;
+    processStats->meanResponseTime = 0;
+    // You could want to put this field to -1
+    processStats->nbContextSwitches = 0;
+
+    addProcessStats(stats, processStats);
+    return true;
 }
 
-void advanceNextEvent(Workload *workload, int pid)
+void advanceNextEvent(SimulationState *state, int pid)
 {
-    int index = getProcessIndex(workload, pid);
-    ProcessEvent *event = workload->processesInfo[index]->nextEvent;
-    ProcessEvent *nextEvent = event->nextEvent;
-    free(event);
-    workload->processesInfo[index]->nextEvent = nextEvent;
+    int index = getProcessIndex(state->workload, pid);
+    if (state->nextEvents[index] < state->workload->eventEnds[index])
+    {
+        state->nextEvents[index]++;
+    }
 }
 
-static void handleSimulationEvents(Computer *computer, Workload *workload, int time, AllStats *stats)
+static bool handleSimulationEvents(Computer *computer, SimulationState *state, int64_t time, AllStats *stats)
 {
     //Ex: if a process arrives in the system, the simulator will call the scheduler to put the process in the ready queue.
-    processArrived(computer->scheduler, workload, time, stats);
-
-    handleSchedulerEvents(computer, time, stats);
+    if (!processArrived(computer->scheduler, state, time, stats) || !handleSchedulerEvents(computer, time, stats))
+        return false;
 
     //Ex: event = hardware events, such as the triggering of an interrupt.
     //Since the disk is idle during an interrupt, we had to add an extra strep of looking in the cores if one was idle
     //This extra step was required to generalise to different interrupt duration
-    bool interrupt = false;
-    for (int i = 0; i < computer->cpu->coreCount; i++)
-    {
-        if (computer->cpu->cores[i]->state == INTERRUPTED)
-        {
-            interrupt = true;
-            break;
-        }
-    }
-    if (!interrupt && computer->disk->processNode && getProcessCurEventTimeLeft(workload, computer->disk->processNode->pcb->pid) == 0) //terminated -> interrupt
+    bool interrupt = firstCoreInState(computer->cpu, INTERRUPTED) >= 0;
+    if (!interrupt && computer->disk->processNode && getProcessCurEventTimeLeft(state, computer->disk->processNode->pcb->pid) == 0) //terminated -> interrupt
     {
         //start interrupt
-        handleInterrupt(computer, workload);
+        return handleInterrupt(computer, state);
     }
+    return true;
 }
 
-void processArrived(Scheduler *scheduler, Workload *workload, int time, AllStats *stats)
+bool processArrived(Scheduler *scheduler, SimulationState *state, int64_t time, AllStats *stats)
 {
-    for (int i = 0; i < getProcessCount(workload); i++)
+    //only the processes arriving now are visited, in order of arrival
+    while (getNextArrivalTime(state) <= time)
     {
-        int pid = getPIDFromWorkload(workload, i);
+        int i = state->stream ? state->stream->nextArrival : state->workload->arrivalOrder[state->nextArrival++];
+        int pid = getPIDFromWorkload(state->workload, i);
         //"The first event will always be a CPU event (at time 0)"
-        if (getProcessStartTime(workload, pid) == time)
+        PCB *pcb = getPCBFromState(state, i);
+        pcb->state = READY;
+        state->activeProcesses[state->nbActiveProcesses++] = i;
+        Node *node = getNodeFromState(state, i);
+        initNode(node, pcb);
+        advanceNextEvent(state, pid);
+        if (!handleProcessForCPU(scheduler, node))
+            return false;
+        getProcessStats(stats, pid)->arrivalTime = time;
+        if (state->stream)
         {
-            PCB *pcb = getPCBFromWorkload(workload, i);
-            pcb->state = READY;
-            Node *node = initNode(pcb);
-            advanceNextEvent(workload, pid);
-            handleProcessForCPU(scheduler, node);
-            getProcessStats(stats, pid)->arrivalTime = time;
+            //the file is sorted by start time: the next line is the next arrival
+            readStreamedProcess(state, stats);
         }
     }
+    return true;
 }
 
-void advanceProcessTime(int time, int nextTime, Workload *workload, Computer *computer, ProcessGraph *graph, AllStats *stats)
+bool advanceProcessTime(int64_t time, int64_t nextTime, SimulationState *simulationState, Computer *computer, ProcessGraph *graph, AllStats *stats)
 {
-    int deltaTime = nextTime - time;
-    for (int i = 0; i < workload->nbProcesses; i++)
+    const Workload *workload = simulationState->workload;
+    int64_t deltaTime = nextTime - time;
+    //a process does not progress beyond its duration (which only happens with inconsistent events)
+    bool progressed = simulationState->nbActiveProcesses == 0;
+    //only the processes arrived and not terminated are visited, the terminated ones leave them (in order)
+    int nbActiveProcesses = 0;
+    for (int k = 0; k < simulationState->nbActiveProcesses; k++)
     {
-        ProcessState state = workload->processesInfo[i]->pcb->state;
+        int i = simulationState->activeProcesses[k];
+        ProcessState state = getPCBFromState(simulationState, i)->state;
+        if (state != TERMINATED)
+        {
+            simulationState->activeProcesses[nbActiveProcesses++] = i;
+        }
+        const Node *node = getNodeFromState(simulationState, i);
         int pid = getPIDFromWorkload(workload, i);
         switch (state)
         {
@@ -596,44 +2676,58 @@ void advanceProcessTime(int time, int nextTime, Workload *workload, Computer *co
                 // * READY: process in readyQueue: update graph/stats
                 // * READY: process in switch-in/switch-out
                 // * READY: process interrupted
-                if (getProcessStartTime(workload, pid) <= time)
-                {
-                    if (processInReadyQueues(computer->scheduler, pid))
-                        getProcessStats(stats, pid)->waitingTime += deltaTime;
-                    addProcessEventToGraph(graph, pid, time, state, NO_CORE);
-                }
+                //the waiting time in the ready queues is computed when the process leaves them
+                //(the processes not started are not active yet)
+                addProcessEventToGraph(graph, pid, time, state, NO_CORE);
                 break;
             case WAITING:
                 addProcessEventToGraph(graph, pid, time, state, NO_CORE);
-                if (computer->disk->state == DISK_RUNNING && computer->disk->processNode->pcb->pid == pid)
+                if (computer->disk->state == DISK_RUNNING && node->onDisk)
                 {
-                    setProcessAdvancementTime(workload, pid, getProcessAdvancementTime(workload, pid) + deltaTime);
+                    progressed |= simulationState->advancementTimes[i] < workload->processDurations[i];
+                    simulationState->advancementTimes[i] += deltaTime;
                     addDiskEventToGraph(graph, pid, time, DISK_RUNNING);
                 }
-                else if (computer->disk->state == DISK_IDLE && computer->disk->processNode->pcb->pid == pid)
+                else if (computer->disk->state == DISK_IDLE && node->onDisk)
                 {
                     addDiskEventToGraph(graph, pid, time, DISK_IDLE);
                 }
                break;
             case RUNNING:
                 getProcessStats(stats, pid)->cpuTime += deltaTime;
-                int core;
-                for (core = 0; core < computer->cpu->coreCount; core++)
-                    if (computer->cpu->cores[core]->processNode && computer->cpu->cores[core]->processNode->pcb->pid == pid)
-                        break;
-                addProcessEventToGraph(graph, pid, time, state, core);
-                setProcessAdvancementTime(workload, pid, getProcessAdvancementTime(workload, pid) + deltaTime);
+                //the core holding the process is recorded on its node when it is put on the CPU
+                addProcessEventToGraph(graph, pid, time, state, node->coreIndex);
+                progressed |= simulationState->advancementTimes[i] < workload->processDurations[i];
+                simulationState->advancementTimes[i] += deltaTime;
                 break;
             case TERMINATED:
+                //last event of the process: the graph keeps its state until the end
                 addProcessEventToGraph(graph, pid, time, state, NO_CORE);
             default:
                 break;
         }
     }
+    simulationState->nbActiveProcesses = nbActiveProcesses;
 
     if (computer->disk->state == DISK_IDLE)
     {
         //Issue on submission platform if not present
         addDiskEventToGraph(graph, -1, time, DISK_IDLE);
     }
+    return progressed;
+}
+
+static int64_t getNextSimulationEventTime(Computer *computer, const SimulationState *state, int64_t time)
+{
+    int64_t nextTime = min64(getNextArrivalTime(state), getNextSchedulingEventTime(computer, time));
+
+    //disk: end of the current IO burst (the interrupt is triggered once it is done)
+    if (computer->disk->state == DISK_RUNNING && computer->disk->processNode)
+    {
+        int64_t timeLeft = getProcessCurEventTimeLeft(state, computer->disk->processNode->pcb->pid);
+        nextTime = min64(nextTime, timeLeft > 0 ? time + timeLeft : time + 1);
+    }
+
+    //nothing planned (should not happen before the end of the workload): fall back on a single time unit
+    return nextTime == INT64_MAX ? time + 1 : nextTime;
 }
@@ -1,6 +1,9 @@
 #ifndef simulation_h
 #define simulation_h
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "graph.h"
 #include "stats.h"
 #include "schedulingAlgorithms.h"
@@ -9,12 +12,68 @@
 
 /* 
  * The Workload struct is used to store the processes that will be simulated.
- * It contains the information of the input file and the advancement of the
- * processes.
+ * It contains the information of the input file and is never modified once
+ * the file is parsed, so that a single workload can be simulated several times
+ * (possibly concurrently) with different parameters.
  */
 typedef struct Workload_t Workload;
 
 
+/* ------------------------ SimulationState struct ------------------------- */
+
+/*
+ * The SimulationState struct contains the advancement of the processes of a
+ * workload during one simulation (state of the processes, position in their
+ * events, next process to arrive). It is created by launchSimulation and only
+ * lives for the duration of the simulation.
+ */
+typedef struct SimulationState_t SimulationState;
+
+
+/* ------------------------ SimulationOptions struct ----------------------- */
+
+#define DEFAULT_SEED 1 // default seed of rand()
+#define DEFAULT_MAX_STALL_TIME 10000 // default simulated time without progress before stopping
+#define MAX_STOP_WARNING 128 // size of the warning of a simulation stopped before the end of the workload
+
+/*
+ * The SimulationOptions struct gathers the options of the simulation that are
+ * not specific to a ready queue.
+ */
+typedef struct SimulationOptions_t SimulationOptions;
+
+struct SimulationOptions_t
+{
+    // true: the main loop jumps directly to the next time at which something
+    // can happen, false: the main loop advances one time unit at a time
+    bool eventDriven;
+    // simulated time after which the simulation is stopped even if the
+    // workload is not over (NO_LIMIT: run to completion)
+    int64_t maxTime;
+    // wall-clock time (in seconds) after which the simulation is stopped
+    // even if the workload is not over (NO_LIMIT: run to completion)
+    double maxWallTime;
+    // simulated time without progress of any process (on a core or on the
+    // disk) while some are in the system after which the simulation is
+    // stopped: the processes are then preempting each other forever
+    int64_t maxStallTime;
+    // seed of the pseudo-random choices of the simulation (e.g. the core
+    // interrupted at the end of an IO burst): same seed, same results
+    unsigned int seed;
+    // true: the input file is read during the simulation instead of being
+    // loaded first (see launchStreamedSimulation)
+    bool stream;
+    // true: each core has its own run queue (multilevel ready queues), idle
+    // cores steal processes from the busiest one, false: the cores share a
+    // single run queue
+    bool perCoreQueues;
+    // NULL: the warning of a simulation stopped before the end of the
+    // workload is printed on stderr, otherwise it is written in this buffer
+    // of MAX_STOP_WARNING bytes instead (empty if the workload is over)
+    char *stopWarning;
+};
+
+
 /* -------------------------- getters and setters -------------------------- */
 
 /**
@@ -34,7 +93,7 @@ int getProcessCount(const Workload *workload);
  *
  * @return the PID of the process at the given index
  */
-int getPIDFromWorkload(Workload *workload, int index);
+int getPIDFromWorkload(const Workload *workload, int index);
 
 /**
  * Get the arrival time of the process with the given PID
@@ -44,7 +103,7 @@ int getPIDFromWorkload(Workload *workload, int index);
  *
  * @return the arrival time of the process
  */
-int getProcessStartTime(Workload *workload, int pid);
+int64_t getProcessStartTime(const Workload *workload, int pid);
 
 /**
  * Get the duration of the process with the given PID
@@ -54,48 +113,92 @@ int getProcessStartTime(Workload *workload, int pid);
  *
  * @return the duration of the process
  */
-int getProcessDuration(Workload *workload, int pid);
+int64_t getProcessDuration(const Workload *workload, int pid);
 
 /**
  * Get the advancement time of the process with the given PID
  *
- * @param workload: the workload
+ * @param state: the state of the simulation
  * @param pid: the PID of the process
  *
  * @return the advancement time of the process
  */
-int getProcessAdvancementTime(Workload *workload, int pid);
+int64_t getProcessAdvancementTime(const SimulationState *state, int pid);
 
 /**
  * Get the next event time of the process with the given PID. This can either
  * be the next CPU or IO event time or the total time if the process has no
  * more events.
  *
- * @param workload: the workload
+ * @param state: the state of the simulation
  * @param pid: the PID of the process
  *
  * @return the next event time of the process
  */
-int getProcessNextEventTime(Workload *workload, int pid);
+int64_t getProcessNextEventTime(const SimulationState *state, int pid);
 
 /**
  * Get the current event time left of the process with the given PID. This can
  * either be the time left until the next CPU or IO event or the time left until
  * the process is finished if it has no more events.
  *
- * @param workload: the workload
+ * @param state: the state of the simulation
  * @param pid: the PID of the process
  *
  * @return the current event time left of the process
  */
-int getProcessCurEventTimeLeft(Workload *workload, int pid);
+int64_t getProcessCurEventTimeLeft(const SimulationState *state, int pid);
+
+
+/**
+ * Get the start time of the next process to arrive in the simulation.
+ *
+ * @param state: the state of the simulation
+ *
+ * @return the next arrival time, or INT64_MAX if all processes have arrived
+ */
+int64_t getNextArrivalTime(const SimulationState *state);
+
+/**
+ * Get the workload simulated with the given state.
+ *
+ * @param state: the state of the simulation
+ *
+ * @return the workload of the simulation
+ */
+const Workload *getSimulationWorkload(const SimulationState *state);
 
 
 /* -------------------------- init/free functions -------------------------- */
 
+/**
+ * Set the given SimulationOptions to their default values.
+ *
+ * @param options: the options to initialize
+ */
+void setDefaultSimulationOptions(SimulationOptions *options);
+
+/**
+ * Parse a simulation option given on the command line (not specific to a
+ * ready queue): --event-driven, --max-time=..., --max-wall-time=...,
+ * --max-stall-time=..., --seed=..., --stream or --per-core-queues. The value
+ * of an option must be a non-negative number (a whole one, except for
+ * --max-wall-time) with nothing after it.
+ *
+ * @param arg: the argument to parse
+ * @param options: the options to fill
+ * @param valid: set to false if the argument is a simulation option with an
+ *               invalid value (the options are then unchanged), true
+ *               otherwise
+ *
+ * @return true if the argument is a simulation option, false otherwise
+ */
+bool parseSimulationOption(const char *arg, SimulationOptions *options, bool *valid);
+
 /**
  * Create a new Workload struct and parse the input file to fill it with the
- * processes. Serves as init function for the Workload struct.
+ * processes. Serves as init function for the Workload struct. The CPU and IO
+ * bursts of a process must alternate.
  *
  * @param fileName: the name of the input file
  *
@@ -103,6 +206,65 @@ int getProcessCurEventTimeLeft(Workload *workload, int pid);
  */
 Workload *parseInputFile(const char *fileName);
 
+/**
+ * Same as parseInputFile, with the given number of threads: a large input
+ * file is split in parts (at the beginning of lines) parsed in parallel and
+ * merged in the order of the file, so the workload does not depend on the
+ * number of threads. parseInputFile uses one thread per online core.
+ *
+ * @param fileName: the name of the input file
+ * @param nbThreads: the maximum number of threads to use
+ *
+ * @return the new Workload struct
+ */
+Workload *parseInputFileWithThreads(const char *fileName, int nbThreads);
+
+/**
+ * Create a new Workload struct from the given file, either a text input file
+ * (see parseInputFile) or a binary workload file (see loadBinaryWorkload),
+ * recognized by its first bytes. Anything but a regular file (a pipe, a FIFO,
+ * ...) is read as a text input file.
+ *
+ * @param fileName: the name of the file
+ *
+ * @return the new Workload struct, or NULL on error
+ */
+Workload *loadWorkload(const char *fileName);
+
+/**
+ * Save the given workload in a binary workload file, which can be loaded
+ * without parsing. All the fields are little-endian:
+ * * header (64 bytes): magic "CPUWKLD\0", version (u32, currently 1), header
+ *   size (u32, 64), number of processes n (u64), number of events m (u64),
+ *   offset of the process table (u64), offset of the burst table (u64),
+ *   16 reserved bytes
+ * * process table, one column after the other: start times (i64 x n),
+ *   durations (i64 x n), index of the first event of each process (i64 x
+ *   n + 1, the last one being m), PIDs (i32 x n), priorities (i32 x n),
+ *   indexes of the processes sorted by start time then by index (i32 x n),
+ *   padding to a multiple of 8 bytes
+ * * burst table: m events of 16 bytes, time relative to the process (i64,
+ *   in [0, duration)), type (u32, 0: CPU, 1: IO, alternating within a
+ *   process), 4 reserved bytes
+ *
+ * @param workload: the workload to save
+ * @param fileName: the name of the binary workload file
+ *
+ * @return true on success, false otherwise
+ */
+bool saveBinaryWorkload(const Workload *workload, const char *fileName);
+
+/**
+ * Create a new Workload struct from a binary workload file (see
+ * saveBinaryWorkload). The file is mapped in memory and its tables are used
+ * as is by the workload, only the PID index is built.
+ *
+ * @param fileName: the name of the binary workload file
+ *
+ * @return the new Workload struct, or NULL on error
+ */
+Workload *loadBinaryWorkload(const char *fileName);
+
 /**
  * Free the memory of the given Workload struct.
  *
@@ -110,12 +272,39 @@ Workload *parseInputFile(const char *fileName);
  */
 void freeWorkload(Workload *workload);
 
+/**
+ * Create a new SimulationState struct for the given workload, ready for a
+ * simulation (see resetSimulationState).
+ *
+ * @param workload: the workload to simulate, it must outlive the state
+ *
+ * @return the new SimulationState struct, or NULL on allocation failure
+ */
+SimulationState *initSimulationState(const Workload *workload);
+
+/**
+ * Reset the given SimulationState to the beginning of a simulation: no
+ * process has arrived and no process has advanced.
+ *
+ * @param state: the SimulationState struct to reset
+ */
+void resetSimulationState(SimulationState *state);
+
+/**
+ * Free the memory of the given SimulationState struct.
+ *
+ * @param state: the SimulationState struct to free
+ */
+void freeSimulationState(SimulationState *state);
+
 
 /* -------------------------- simulation functions ------------------------- */
 
 /**
  * Simulate the given workload with the given scheduling algorithms and store
- * the results in the given stats and graph struct.
+ * the results in the given stats and graph struct. The workload is not
+ * modified: the advancement of the processes is stored in a SimulationState
+ * owned by the simulation.
  *
  * @param workload: the workload to simulate
  * @param algorithms: the algorithms to use for the simulation, each algorithm
@@ -123,18 +312,44 @@ void freeWorkload(Workload *workload);
  *                  are given in the array (first algo is on first queue, etc.)
  * @param algorithmCount: the amount of algorithms/ready queues to use
  * @param cpuCoreCount: the amount of CPU cores to simulate on
- * @param graph: the graph struct to store the results of the simulation
+ * @param graph: the graph struct to store the results of the simulation (can
+ *               be NULL to not build the graph)
  * @param stats: the stats struct to store the results of the simulation
+ * @param options: the options of the simulation
+ *
+ * @return true on success, false if the simulation could not be initialized
+ *         (error reported, the algorithms are freed in any case)
+ */
+bool launchSimulation(const Workload *workload, SchedulingAlgorithm **algorithms, int algorithmCount, int cpuCoreCount, ProcessGraph *graph, AllStats *stats, const SimulationOptions *options);
+
+/**
+ * Simulate the processes of the given text input file, read as the simulated
+ * time reaches their start time: the file must be sorted by start time. The
+ * memory of a process (including its stats, retired with retireProcessStats)
+ * is released once it is terminated, so the memory used depends on the
+ * number of processes in the system at the same time, not on the length of
+ * the file. Only the summary of the stats (see getStatsSummary) covers all the
+ * processes, and no graph is built.
+ *
+ * @param fileName: the name of the text input file
+ * @param algorithms: the algorithms of the ready queues (see launchSimulation)
+ * @param algorithmCount: the amount of algorithms/ready queues to use
+ * @param cpuCoreCount: the amount of CPU cores to simulate on
+ * @param stats: the stats struct to store the results of the simulation
+ * @param options: the options of the simulation
+ *
+ * @return true on success, false if the file could not be read (error
+ *         reported, the simulation stops at the first invalid process)
  */
-void launchSimulation(Workload *workload, SchedulingAlgorithm **algorithms, int algorithmCount, int cpuCoreCount, ProcessGraph *graph, AllStats *stats);
+bool launchStreamedSimulation(const char *fileName, SchedulingAlgorithm **algorithms, int algorithmCount, int cpuCoreCount, AllStats *stats, const SimulationOptions *options);
 
 
 /**
  * Advances to the next event in the workload for the specified process ID.
  *
- * @param workload The pointer to the Workload structure.
+ * @param state The pointer to the SimulationState structure.
  * @param pid The process ID for which to advance the next event.
  */
-void advanceNextEvent(Workload *workload, int pid);
+void advanceNextEvent(SimulationState *state, int pid);
 
 #endif // simulation_h
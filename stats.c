@@ -3,8 +3,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <inttypes.h>
 
 #include "stats.h"
+#include "utils.h"
 
 
 /* -------------------------- struct definitions -------------------------- */
@@ -15,9 +17,42 @@ struct AllStats_t
 
     int nbProcesses;
     int nbProcessesDone;
+
+    // processId -> position in processesStatsArray: open-addressing hash
+    // table (linear probing) of size indexSize (a power of 2), indexKeys[i]
+    // being the processId stored in the slot i (-1 in index if empty)
+    int indexSize;
+    int *indexKeys;
+    int *index;
+
+    // totals of the stats removed by retireProcessStats
+    int nbRetired;
+    int nbRetiredFinished;
+    int64_t retiredMakespan;
+    double retiredTurnaroundTime;
+    double retiredWaitingTime;
+    double retiredResponseTime;
+    int64_t retiredContextSwitches;
+
+    LoadBalanceStats loadBalance;
 };
 
 
+/* ---------------------------- static functions --------------------------- */
+
+/**
+ * Return the slot of the given processId in the hash table of the stats:
+ * either the slot containing it or the empty slot where it should be inserted.
+ */
+static int getIndexSlot(const AllStats *stats, int processId);
+
+/**
+ * Return the slot where the given processId would be stored without
+ * collision (start of its probe sequence).
+ */
+static unsigned int getIndexHome(const AllStats *stats, int processId);
+
+
 /* ------------------------- function definitions ------------------------- */
 
 AllStats *initStats(void)
@@ -33,6 +68,22 @@ AllStats *initStats(void)
 
     stats->processesStatsArray = NULL;
 
+    stats->indexSize = 0;
+    stats->indexKeys = NULL;
+    stats->index = NULL;
+
+    stats->nbRetired = 0;
+    stats->nbRetiredFinished = 0;
+    stats->retiredMakespan = 0;
+    stats->retiredTurnaroundTime = 0;
+    stats->retiredWaitingTime = 0;
+    stats->retiredResponseTime = 0;
+    stats->retiredContextSwitches = 0;
+
+    stats->loadBalance.nbStealAttempts = 0;
+    stats->loadBalance.nbSteals = 0;
+    stats->loadBalance.nbMigrations = 0;
+
     return stats;
 }
 
@@ -43,6 +94,8 @@ void freeStats(AllStats *stats)
         free(stats->processesStatsArray[i]);
     }
     free(stats->processesStatsArray);
+    free(stats->indexKeys);
+    free(stats->index);
     free(stats);
 }
 
@@ -52,6 +105,38 @@ void setNbProcessesInStats(AllStats *stats, int nbProcesses)
             stats->processesStatsArray, nbProcesses * sizeof(ProcessStats *));
 
     stats->nbProcesses = nbProcesses;
+
+    // load factor <= 1/2 to keep the probe sequences short
+    int indexSize = 1;
+    while (indexSize < 2 * nbProcesses)
+    {
+        indexSize *= 2;
+    }
+    free(stats->indexKeys);
+    free(stats->index);
+    stats->indexSize = indexSize;
+    stats->indexKeys = (int *) malloc(indexSize * sizeof(int));
+    stats->index = (int *) malloc(indexSize * sizeof(int));
+    if (!stats->indexKeys || !stats->index)
+    {
+        fprintf(stderr, "Error: could not allocate memory for the stats index\n");
+        free(stats->indexKeys);
+        free(stats->index);
+        stats->indexSize = 0;
+        stats->indexKeys = NULL;
+        stats->index = NULL;
+        return;
+    }
+    for (int i = 0; i < indexSize; i++)
+    {
+        stats->index[i] = -1;
+    }
+    for (int i = 0; i < stats->nbProcessesDone; i++)
+    {
+        int slot = getIndexSlot(stats, stats->processesStatsArray[i]->processId);
+        stats->indexKeys[slot] = stats->processesStatsArray[i]->processId;
+        stats->index[slot] = i;
+    }
 }
 
 void addProcessStats(AllStats *stats, ProcessStats *processStats)
@@ -63,22 +148,83 @@ void addProcessStats(AllStats *stats, ProcessStats *processStats)
         return;
     }
 
+    if (stats->index)
+    {
+        int slot = getIndexSlot(stats, processStats->processId);
+        if (stats->index[slot] == -1)
+        {
+            stats->indexKeys[slot] = processStats->processId;
+            stats->index[slot] = stats->nbProcessesDone;
+        }
+    }
     stats->processesStatsArray[stats->nbProcessesDone++] = processStats;
 }
 
 ProcessStats *getProcessStats(AllStats *stats, int processId)
 {
-    // Yes, the complexity is O(n) but it's not a problem here. You can use it
-    // as much as you want without being penalized.
-    for (int i = 0; i < stats->nbProcessesDone; i++)
+    if (!stats->index)
     {
-        if (stats->processesStatsArray[i]->processId == processId)
+        return NULL;
+    }
+
+    int position = stats->index[getIndexSlot(stats, processId)];
+    return position == -1 ? NULL : stats->processesStatsArray[position];
+}
+
+void retireProcessStats(AllStats *stats, int processId)
+{
+    if (!stats->index)
+    {
+        return;
+    }
+    int slot = getIndexSlot(stats, processId);
+    int position = stats->index[slot];
+    if (position == -1)
+    {
+        return;
+    }
+
+    ProcessStats *processStats = stats->processesStatsArray[position];
+    stats->nbRetired++;
+    stats->retiredContextSwitches += processStats->nbContextSwitches;
+    if (processStats->finishTime != 0) // finished
+    {
+        stats->nbRetiredFinished++;
+        if (processStats->finishTime > stats->retiredMakespan)
         {
-            return stats->processesStatsArray[i];
+            stats->retiredMakespan = processStats->finishTime;
         }
+        stats->retiredTurnaroundTime += processStats->turnaroundTime;
+        stats->retiredWaitingTime += processStats->waitingTime;
+        stats->retiredResponseTime += processStats->meanResponseTime;
     }
+    free(processStats);
 
-    return NULL;
+    // the last stats take the freed position
+    int last = --stats->nbProcessesDone;
+    if (position != last)
+    {
+        stats->processesStatsArray[position] = stats->processesStatsArray[last];
+        stats->index[getIndexSlot(stats, stats->processesStatsArray[position]->processId)] = position;
+    }
+
+    // backward shift deletion: the following entries of the probe sequence
+    // move back into the hole if it is on their own probe sequence
+    unsigned int mask = (unsigned int) stats->indexSize - 1;
+    unsigned int hole = (unsigned int) slot;
+    unsigned int next = (hole + 1) & mask;
+    while (stats->index[next] != -1)
+    {
+        unsigned int home = getIndexHome(stats, stats->indexKeys[next]);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            stats->indexKeys[hole] = stats->indexKeys[next];
+            stats->index[hole] = stats->index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    stats->index[hole] = -1;
 }
 
 void printStats(AllStats *stats)
@@ -90,7 +236,8 @@ void printStats(AllStats *stats)
     {
         const ProcessStats *processStats = stats->processesStatsArray[i];
 
-        printf("%3d | %8d | %7d | %6d | %10d | %3d | %7d | %8.2f | %11d\n",
+        printf("%3d | %8d | %7" PRId64 " | %6" PRId64 " | %10" PRId64 " | %3" PRId64
+               " | %7" PRId64 " | %8.2f | %11" PRId64 "\n",
                processStats->processId, processStats->priority,
                processStats->arrivalTime, processStats->finishTime,
                processStats->turnaroundTime, processStats->cpuTime,
@@ -98,3 +245,84 @@ void printStats(AllStats *stats)
                processStats->nbContextSwitches);
     }
 }
+
+void getStatsSummary(const AllStats *stats, StatsSummary *summary)
+{
+    summary->nbProcesses = stats->nbRetired + stats->nbProcessesDone;
+    summary->nbProcessesFinished = stats->nbRetiredFinished;
+    summary->makespan = stats->retiredMakespan;
+    summary->meanTurnaroundTime = stats->retiredTurnaroundTime;
+    summary->meanWaitingTime = stats->retiredWaitingTime;
+    summary->meanResponseTime = stats->retiredResponseTime;
+    summary->nbContextSwitches = stats->retiredContextSwitches;
+
+    for (int i = 0; i < stats->nbProcessesDone; i++)
+    {
+        const ProcessStats *processStats = stats->processesStatsArray[i];
+
+        summary->nbContextSwitches += processStats->nbContextSwitches;
+        if (processStats->finishTime == 0) // not finished
+        {
+            continue;
+        }
+        summary->nbProcessesFinished++;
+        if (processStats->finishTime > summary->makespan)
+        {
+            summary->makespan = processStats->finishTime;
+        }
+        summary->meanTurnaroundTime += processStats->turnaroundTime;
+        summary->meanWaitingTime += processStats->waitingTime;
+        summary->meanResponseTime += processStats->meanResponseTime;
+    }
+
+    if (summary->nbProcessesFinished > 0)
+    {
+        summary->meanTurnaroundTime /= summary->nbProcessesFinished;
+        summary->meanWaitingTime /= summary->nbProcessesFinished;
+        summary->meanResponseTime /= summary->nbProcessesFinished;
+    }
+}
+
+
+void printStatsSummary(const StatsSummary *summary)
+{
+    puts("PROCESSES | FINISHED | MAKESPAN | TURNAROUND | WAITING | RESPONSE | "
+         "C. SWITCHES");
+    printf("%9d | %8d | %8" PRId64 " | %10.2f | %7.2f | %8.2f | %11" PRId64 "\n",
+           summary->nbProcesses, summary->nbProcessesFinished,
+           summary->makespan, summary->meanTurnaroundTime,
+           summary->meanWaitingTime, summary->meanResponseTime,
+           summary->nbContextSwitches);
+}
+
+void setLoadBalanceStats(AllStats *stats, const LoadBalanceStats *loadBalance)
+{
+    stats->loadBalance = *loadBalance;
+}
+
+void printLoadBalanceStats(const AllStats *stats)
+{
+    puts("STEAL ATTEMPTS | STEALS | MIGRATIONS");
+    printf("%14" PRId64 " | %6" PRId64 " | %10" PRId64 "\n",
+           stats->loadBalance.nbStealAttempts, stats->loadBalance.nbSteals,
+           stats->loadBalance.nbMigrations);
+}
+
+
+/* ---------------------------- static functions --------------------------- */
+
+static unsigned int getIndexHome(const AllStats *stats, int processId)
+{
+    return getHashHome(processId, stats->indexSize);
+}
+
+static int getIndexSlot(const AllStats *stats, int processId)
+{
+    unsigned int mask = (unsigned int) stats->indexSize - 1;
+    unsigned int slot = getIndexHome(stats, processId);
+    while (stats->index[slot] != -1 && stats->indexKeys[slot] != processId)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
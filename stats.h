@@ -1,21 +1,49 @@
 #ifndef stats_h
 #define stats_h
 
+#include <stdint.h>
+
 typedef struct AllStats_t AllStats;
 typedef struct ProcessStats_t ProcessStats;
+typedef struct StatsSummary_t StatsSummary;
+typedef struct LoadBalanceStats_t LoadBalanceStats;
 
 struct ProcessStats_t {
     int processId;
     int priority;
-    int arrivalTime;
-    int finishTime;
-    int turnaroundTime;
-    int cpuTime;
+    int64_t arrivalTime;
+    int64_t finishTime;
+    int64_t turnaroundTime;
+    int64_t cpuTime;
     // /!\ waiting to be executed -> waiting inside the ready queue, not the
     // wait queue
-    int waitingTime;
+    int64_t waitingTime;
+    double meanResponseTime;
+    int64_t nbContextSwitches;
+};
+
+// Aggregate of the ProcessStats of a simulation, the means are computed over
+// the finished processes only
+struct StatsSummary_t {
+    int nbProcesses;
+    int nbProcessesFinished;
+    int64_t makespan; // latest finish time
+    double meanTurnaroundTime;
+    double meanWaitingTime;
     double meanResponseTime;
-    int nbContextSwitches;
+    int64_t nbContextSwitches; // total over all processes
+};
+
+// Counters of the load balancing between the run queues of the cores
+// (--per-core-queues), over the whole simulation
+struct LoadBalanceStats_t {
+    // an idle core with an empty run queue looked for a process to steal
+    // while processes were still waiting in the run queues of other cores
+    int64_t nbStealAttempts;
+    // the attempt found a process
+    int64_t nbSteals;
+    // a process started running on another core than the last one it ran on
+    int64_t nbMigrations;
 };
 
 
@@ -64,6 +92,17 @@ void addProcessStats(AllStats *stats, ProcessStats *processStats);
  */
 ProcessStats *getProcessStats(AllStats *stats, int processId);
 
+/**
+ * Removes the statistics of a process that will not change anymore, freeing
+ * them: they are no longer returned by getProcessStats nor printed by
+ * printStats, but are still counted by getStatsSummary. The order of the
+ * remaining statistics may change.
+ *
+ * @param stats The pointer to the AllStats structure containing all the process statistics.
+ * @param processId The ID of the process whose statistics are removed.
+ */
+void retireProcessStats(AllStats *stats, int processId);
+
 /**
  * Prints the statistics of the given AllStats object.
  *
@@ -71,4 +110,34 @@ ProcessStats *getProcessStats(AllStats *stats, int processId);
  */
 void printStats(AllStats *stats);
 
+/**
+ * Computes the summary of the statistics of the given AllStats object.
+ *
+ * @param stats The pointer to the AllStats object.
+ * @param summary The pointer to the StatsSummary structure to fill.
+ */
+void getStatsSummary(const AllStats *stats, StatsSummary *summary);
+
+/**
+ * Prints the given summary of statistics.
+ *
+ * @param summary The pointer to the StatsSummary structure to print.
+ */
+void printStatsSummary(const StatsSummary *summary);
+
+/**
+ * Sets the load balancing counters of the simulation.
+ *
+ * @param stats The pointer to the AllStats structure.
+ * @param loadBalance The counters, copied.
+ */
+void setLoadBalanceStats(AllStats *stats, const LoadBalanceStats *loadBalance);
+
+/**
+ * Prints the load balancing counters of the given AllStats object.
+ *
+ * @param stats The pointer to the AllStats object.
+ */
+void printLoadBalanceStats(const AllStats *stats);
+
 #endif // stats_h
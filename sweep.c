@@ -0,0 +1,684 @@
+// Sweep mode: simulates a grid of configurations on a single parsed workload
+// with a pool of threads and prints a summary table.
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "sweep.h"
+#include "stats.h"
+#include "utils.h"
+#include "schedulingAlgorithms.h"
+
+#define MAX_ALGORITHM_NAME 16
+#define MAX_CONFIG_DESCRIPTION 256
+
+
+/* --------------------------- struct definitions -------------------------- */
+
+/**
+ * List of values to sweep for a parameter.
+ */
+typedef struct SweepValues_t SweepValues;
+struct SweepValues_t
+{
+    int count;
+    int64_t *values;
+};
+
+/**
+ * Values to sweep for one ready queue of a layout. The RR slices are only
+ * swept for the RR algorithm (the other algorithms do not use it).
+ */
+typedef struct SweepQueue_t SweepQueue;
+struct SweepQueue_t
+{
+    int nbTypes;
+    SchedulingAlgorithmType *types;
+    SweepValues RRSlices;
+    SweepValues limits;
+    SweepValues ages;
+};
+
+/**
+ * Ready queues layout (-q) and the values to sweep for each queue.
+ */
+typedef struct SweepLayout_t SweepLayout;
+struct SweepLayout_t
+{
+    int nbQueues;
+    int nbQueuesParsed;
+    SweepQueue *queues;
+};
+
+/**
+ * One configuration of the grid and the summary of its simulation.
+ */
+typedef struct SweepConfig_t SweepConfig;
+struct SweepConfig_t
+{
+    int coreCount;
+    int nbQueues;
+    SchedulingAlgorithm *algorithms; // nbQueues algorithms inside sweep->algorithms
+    bool done;
+    StatsSummary summary;
+    char stopWarning[MAX_STOP_WARNING]; // why the simulation stopped before the end of the workload, "" if it did not
+};
+
+struct Sweep_t
+{
+    SweepValues coreCounts;
+    int nbLayouts;
+    SweepLayout *layouts;
+    SimulationOptions options;
+    int nbThreads;
+
+    // grid of configurations, built once the arguments are parsed
+    int nbConfigs;
+    SweepConfig *configs;
+    int nbAlgorithms;
+    SchedulingAlgorithm *algorithms; // algorithms of all the configurations
+
+    // worker pool: the workers take the configurations in order
+    const Workload *workload;
+    pthread_mutex_t lock;
+    int nextConfig;
+};
+
+
+/* ---------------------------- static functions --------------------------- */
+
+/**
+ * Parse a comma-separated list of integers, each checked as the value of a
+ * command line option (see parseOptionValue).
+ *
+ * @param arg: the list to parse
+ * @param minValue: the minimum value allowed
+ * @param maxValue: the maximum value allowed
+ * @param values: the list of values to fill (replaces the previous values)
+ *
+ * @return true on success, false if the list is invalid
+ */
+static bool parseValueList(const char *arg, int64_t minValue, int64_t maxValue, SweepValues *values);
+
+/**
+ * Parse a comma-separated list of algorithm types.
+ *
+ * @param arg: the list to parse
+ * @param queue: the queue whose types are filled
+ *
+ * @return true on success, false if the list is invalid
+ */
+static bool parseAlgorithmList(const char *arg, SweepQueue *queue);
+
+/**
+ * Set a list of values to the single value NO_LIMIT.
+ *
+ * @param values: the list of values to set
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool setDefaultValues(SweepValues *values);
+
+/**
+ * Build the grid of configurations of the sweep from the parsed values.
+ *
+ * @param sweep: the sweep
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool buildConfigs(Sweep *sweep);
+
+/**
+ * Add the configurations of the given layout to the grid, for the ready
+ * queues from the given one (the previous ones being set in current, which
+ * is copied in the grid for each configuration).
+ *
+ * @param sweep: the sweep
+ * @param coreCount: the number of cores of the configurations
+ * @param layout: the layout of the configurations
+ * @param queue: the first ready queue to sweep
+ * @param current: the algorithms of the ready queues being built
+ */
+static void addLayoutConfigs(Sweep *sweep, int coreCount, const SweepLayout *layout, int queue, SchedulingAlgorithm *current);
+
+/**
+ * Return the number of configurations of one ready queue of a layout.
+ *
+ * @param queue: the ready queue
+ *
+ * @return the number of configurations of the queue
+ */
+static int64_t getQueueConfigCount(const SweepQueue *queue);
+
+/**
+ * Worker of the thread pool: simulates configurations until there are none
+ * left.
+ *
+ * @param arg: the sweep
+ *
+ * @return NULL
+ */
+static void *sweepWorker(void *arg);
+
+/**
+ * Simulate one configuration of the sweep and store the summary of its stats.
+ *
+ * @param sweep: the sweep
+ * @param config: the configuration to simulate
+ */
+static void runSweepConfig(const Sweep *sweep, SweepConfig *config);
+
+/**
+ * Write the description of the ready queues of a configuration.
+ *
+ * @param config: the configuration
+ * @param description: the buffer to write the description in
+ * @param size: the size of the buffer
+ */
+static void describeConfig(const SweepConfig *config, char *description, size_t size);
+
+/**
+ * Print the summary table of the sweep, then the warnings of the configurations
+ * stopped before the end of the workload, in the order of the table.
+ *
+ * @param sweep: the sweep
+ */
+static void printSweepResults(const Sweep *sweep);
+
+
+/* -------------------------- init/free functions -------------------------- */
+
+Sweep *parseSweepArguments(int argc, const char *argv[])
+{
+    Sweep *sweep = (Sweep *) calloc(1, sizeof(Sweep));
+    if (!sweep)
+    {
+        fprintf(stderr, "Error: could not allocate memory for the sweep\n");
+        return NULL;
+    }
+    setDefaultSimulationOptions(&sweep->options);
+    sweep->nbThreads = getOnlineCoreCount();
+
+    SweepLayout *layout = NULL;
+    SweepQueue *queue = NULL;
+    for (int i = 3; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        bool valid = true;
+        if (parseSimulationOption(arg, &sweep->options, &valid))
+        {
+            // not part of the grid, checked below
+        }
+        else if (strncmp(arg, "--threads=", 10) == 0)
+        {
+            int64_t nbThreads;
+            valid = parseOptionValue(arg + 10, 1, INT32_MAX, &nbThreads);
+            if (valid)
+                sweep->nbThreads = (int) nbThreads;
+        }
+        else if (strcmp(arg, "-c") == 0 && i + 1 < argc)
+        {
+            valid = parseValueList(argv[++i], 1, INT32_MAX, &sweep->coreCounts);
+        }
+        else if (strcmp(arg, "-q") == 0 && i + 1 < argc)
+        {
+            if (layout && layout->nbQueuesParsed != layout->nbQueues)
+            {
+                fprintf(stderr, "Error: Missing algorithm options in a ready queue layout\n");
+                freeSweep(sweep);
+                return NULL;
+            }
+            int64_t nbQueues;
+            bool validQueues = parseOptionValue(argv[++i], 1, INT32_MAX, &nbQueues);
+            SweepLayout *layouts = (SweepLayout *) realloc(sweep->layouts, (sweep->nbLayouts + 1) * sizeof(SweepLayout));
+            if (!validQueues || !layouts)
+            {
+                fprintf(stderr, "Error: Invalid number of ready queues\n");
+                if (layouts)
+                    sweep->layouts = layouts;
+                freeSweep(sweep);
+                return NULL;
+            }
+            sweep->layouts = layouts;
+            layout = &sweep->layouts[sweep->nbLayouts++];
+            layout->nbQueues = (int) nbQueues;
+            layout->nbQueuesParsed = 0;
+            layout->queues = (SweepQueue *) calloc(nbQueues, sizeof(SweepQueue));
+            queue = NULL;
+            valid = layout->queues != NULL;
+        }
+        else if (strncmp(arg, "--algorithm=", 12) == 0 && layout && layout->nbQueuesParsed < layout->nbQueues)
+        {
+            queue = &layout->queues[layout->nbQueuesParsed++];
+            valid = parseAlgorithmList(arg + 12, queue)
+                    && setDefaultValues(&queue->RRSlices)
+                    && setDefaultValues(&queue->limits)
+                    && setDefaultValues(&queue->ages);
+        }
+        else if (strncmp(arg, "--RRSlice=", 10) == 0 && queue)
+        {
+            valid = parseValueList(arg + 10, 1, MAX_LIMIT, &queue->RRSlices);
+        }
+        else if (strncmp(arg, "--limit=", 8) == 0 && queue)
+        {
+            valid = parseValueList(arg + 8, 1, MAX_LIMIT, &queue->limits);
+        }
+        else if (strncmp(arg, "--age=", 6) == 0 && queue)
+        {
+            valid = parseValueList(arg + 6, 1, MAX_LIMIT, &queue->ages);
+            if (queue == &layout->queues[0])
+            {
+                fprintf(stderr, "Warning: --age has no effect on queue 0, there is no queue before it\n");
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Error: Unknown or misplaced sweep option %s\n", arg);
+            freeSweep(sweep);
+            return NULL;
+        }
+
+        if (!valid)
+        {
+            fprintf(stderr, "Error: Invalid sweep option %s\n", arg);
+            freeSweep(sweep);
+            return NULL;
+        }
+    }
+
+    if (sweep->coreCounts.count == 0 || sweep->nbLayouts == 0
+        || layout->nbQueuesParsed != layout->nbQueues)
+    {
+        fprintf(stderr, "Error: A sweep needs -c, at least one -q and the algorithm options of each ready queue\n");
+        freeSweep(sweep);
+        return NULL;
+    }
+
+    if (sweep->options.stream)
+    {
+        fprintf(stderr, "Error: --stream cannot be used with --sweep, the workload is simulated several times\n");
+        freeSweep(sweep);
+        return NULL;
+    }
+
+    if (!buildConfigs(sweep))
+    {
+        freeSweep(sweep);
+        return NULL;
+    }
+
+    return sweep;
+}
+
+void freeSweep(Sweep *sweep)
+{
+    for (int i = 0; i < sweep->nbLayouts; i++)
+    {
+        SweepLayout *layout = &sweep->layouts[i];
+        for (int j = 0; layout->queues && j < layout->nbQueues; j++)
+        {
+            free(layout->queues[j].types);
+            free(layout->queues[j].RRSlices.values);
+            free(layout->queues[j].limits.values);
+            free(layout->queues[j].ages.values);
+        }
+        free(layout->queues);
+    }
+    free(sweep->layouts);
+    free(sweep->coreCounts.values);
+    free(sweep->configs);
+    free(sweep->algorithms);
+    free(sweep);
+}
+
+
+/* ---------------------------- sweep functions ---------------------------- */
+
+bool runSweep(Sweep *sweep, const Workload *workload)
+{
+    int nbThreads = min(sweep->nbThreads, sweep->nbConfigs);
+    pthread_t *threads = (pthread_t *) malloc(nbThreads * sizeof(pthread_t));
+    if (!threads)
+    {
+        fprintf(stderr, "Error: could not allocate memory for the sweep threads\n");
+        return false;
+    }
+
+    sweep->workload = workload;
+    sweep->nextConfig = 0;
+    if (pthread_mutex_init(&sweep->lock, NULL) != 0)
+    {
+        fprintf(stderr, "Error: could not initialize the sweep lock\n");
+        free(threads);
+        return false;
+    }
+
+    double startTime = getWallClockTime();
+    int nbStarted = 0;
+    for (; nbStarted < nbThreads; nbStarted++)
+    {
+        if (pthread_create(&threads[nbStarted], NULL, sweepWorker, sweep) != 0)
+        {
+            break;
+        }
+    }
+    if (nbStarted == 0)
+    {
+        // no thread could be created: simulate everything in this one
+        sweepWorker(sweep);
+    }
+    for (int i = 0; i < nbStarted; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    double sweepTime = getWallClockTime() - startTime;
+
+    pthread_mutex_destroy(&sweep->lock);
+    free(threads);
+
+    printf("Sweep: %d configurations, %d threads, %.3f s\n", sweep->nbConfigs, nbStarted > 0 ? nbStarted : 1, sweepTime);
+    printSweepResults(sweep);
+
+    return true;
+}
+
+
+/* ---------------------------- static functions --------------------------- */
+
+static bool parseValueList(const char *arg, int64_t minValue, int64_t maxValue, SweepValues *values)
+{
+    // the values are split in a copy of the list, to parse each one on its own
+    size_t length = strlen(arg);
+    char *list = (char *) malloc(length + 1);
+    int count = 1;
+    for (const char *c = arg; *c; c++)
+    {
+        if (*c == ',')
+            count++;
+    }
+
+    int64_t *parsed = (int64_t *) malloc(count * sizeof(int64_t));
+    if (!list || !parsed)
+    {
+        free(list);
+        free(parsed);
+        return false;
+    }
+    memcpy(list, arg, length + 1);
+    char *start = list;
+    for (int i = 0; i < count; i++)
+    {
+        // the last value ends the list
+        char *end = i + 1 < count ? strchr(start, ',') : start + strlen(start);
+        *end = '\0';
+        if (!parseOptionValue(start, minValue, maxValue, &parsed[i]))
+        {
+            free(list);
+            free(parsed);
+            return false;
+        }
+        start = end + 1;
+    }
+    free(list);
+
+    free(values->values);
+    values->values = parsed;
+    values->count = count;
+    return true;
+}
+
+static bool parseAlgorithmList(const char *arg, SweepQueue *queue)
+{
+    int count = 1;
+    for (const char *c = arg; *c; c++)
+    {
+        if (*c == ',')
+            count++;
+    }
+
+    queue->types = (SchedulingAlgorithmType *) malloc(count * sizeof(SchedulingAlgorithmType));
+    if (!queue->types)
+    {
+        return false;
+    }
+    const char *start = arg;
+    for (int i = 0; i < count; i++)
+    {
+        const char *end = strchr(start, ',');
+        size_t length = end ? (size_t) (end - start) : strlen(start);
+        if (length == 0 || length >= MAX_ALGORITHM_NAME)
+        {
+            return false;
+        }
+
+        char name[MAX_ALGORITHM_NAME];
+        memcpy(name, start, length);
+        name[length] = '\0';
+        SchedulingAlgorithm algorithm;
+        setAlgorithmType(&algorithm, name); // exits on unknown algorithm, as for a single run
+        queue->types[i] = algorithm.type;
+
+        start += length + 1;
+    }
+    queue->nbTypes = count;
+    return true;
+}
+
+static bool setDefaultValues(SweepValues *values)
+{
+    values->values = (int64_t *) malloc(sizeof(int64_t));
+    if (!values->values)
+    {
+        return false;
+    }
+    values->values[0] = NO_LIMIT;
+    values->count = 1;
+    return true;
+}
+
+static int64_t getQueueConfigCount(const SweepQueue *queue)
+{
+    int64_t count = 0;
+    for (int i = 0; i < queue->nbTypes; i++)
+    {
+        count += queue->types[i] == RR ? queue->RRSlices.count : 1;
+    }
+    return count * queue->limits.count * queue->ages.count;
+}
+
+static bool buildConfigs(Sweep *sweep)
+{
+    int64_t nbConfigs = 0;
+    int64_t nbAlgorithms = 0;
+    for (int i = 0; i < sweep->nbLayouts; i++)
+    {
+        int64_t layoutCount = sweep->coreCounts.count;
+        for (int j = 0; j < sweep->layouts[i].nbQueues && layoutCount <= INT32_MAX; j++)
+        {
+            layoutCount *= getQueueConfigCount(&sweep->layouts[i].queues[j]);
+        }
+        nbConfigs += layoutCount;
+        nbAlgorithms += layoutCount * sweep->layouts[i].nbQueues;
+        if (nbConfigs > INT32_MAX || nbAlgorithms > INT32_MAX)
+        {
+            fprintf(stderr, "Error: too many configurations in the sweep\n");
+            return false;
+        }
+    }
+
+    sweep->configs = (SweepConfig *) malloc(nbConfigs * sizeof(SweepConfig));
+    sweep->algorithms = (SchedulingAlgorithm *) malloc(nbAlgorithms * sizeof(SchedulingAlgorithm));
+    if (!sweep->configs || !sweep->algorithms)
+    {
+        fprintf(stderr, "Error: could not allocate memory for the sweep configurations\n");
+        return false;
+    }
+
+    sweep->nbConfigs = 0;
+    sweep->nbAlgorithms = 0;
+    for (int i = 0; i < sweep->nbLayouts; i++)
+    {
+        SchedulingAlgorithm *current = (SchedulingAlgorithm *) malloc(sweep->layouts[i].nbQueues * sizeof(SchedulingAlgorithm));
+        if (!current)
+        {
+            fprintf(stderr, "Error: could not allocate memory for the sweep configurations\n");
+            return false;
+        }
+        for (int j = 0; j < sweep->coreCounts.count; j++)
+        {
+            addLayoutConfigs(sweep, (int) sweep->coreCounts.values[j], &sweep->layouts[i], 0, current);
+        }
+        free(current);
+    }
+
+    return true;
+}
+
+static void addLayoutConfigs(Sweep *sweep, int coreCount, const SweepLayout *layout, int queue, SchedulingAlgorithm *current)
+{
+    if (queue == layout->nbQueues)
+    {
+        SweepConfig *config = &sweep->configs[sweep->nbConfigs++];
+        config->coreCount = coreCount;
+        config->nbQueues = layout->nbQueues;
+        config->algorithms = &sweep->algorithms[sweep->nbAlgorithms];
+        memcpy(config->algorithms, current, layout->nbQueues * sizeof(SchedulingAlgorithm));
+        sweep->nbAlgorithms += layout->nbQueues;
+        config->done = false;
+        config->stopWarning[0] = '\0';
+        return;
+    }
+
+    const SweepQueue *values = &layout->queues[queue];
+    for (int t = 0; t < values->nbTypes; t++)
+    {
+        int nbRRSlices = values->types[t] == RR ? values->RRSlices.count : 1;
+        for (int s = 0; s < nbRRSlices; s++)
+        {
+            for (int l = 0; l < values->limits.count; l++)
+            {
+                for (int a = 0; a < values->ages.count; a++)
+                {
+                    current[queue].type = values->types[t];
+                    current[queue].RRSliceLimit = values->types[t] == RR ? values->RRSlices.values[s] : NO_LIMIT;
+                    current[queue].executiontTimeLimit = values->limits.values[l];
+                    current[queue].ageLimit = values->ages.values[a];
+                    addLayoutConfigs(sweep, coreCount, layout, queue + 1, current);
+                }
+            }
+        }
+    }
+}
+
+static void *sweepWorker(void *arg)
+{
+    Sweep *sweep = (Sweep *) arg;
+    while (true)
+    {
+        pthread_mutex_lock(&sweep->lock);
+        int configIndex = sweep->nextConfig++;
+        pthread_mutex_unlock(&sweep->lock);
+        if (configIndex >= sweep->nbConfigs)
+        {
+            break;
+        }
+        runSweepConfig(sweep, &sweep->configs[configIndex]);
+    }
+    return NULL;
+}
+
+static void runSweepConfig(const Sweep *sweep, SweepConfig *config)
+{
+    AllStats *stats = initStats();
+    // the scheduler takes the ownership of the algorithms
+    SchedulingAlgorithm **algorithms = (SchedulingAlgorithm **) malloc(config->nbQueues * sizeof(SchedulingAlgorithm *));
+    if (!stats || !algorithms)
+    {
+        fprintf(stderr, "Error: could not allocate memory for a sweep configuration\n");
+        if (stats)
+            freeStats(stats);
+        free(algorithms);
+        return;
+    }
+    for (int i = 0; i < config->nbQueues; i++)
+    {
+        const SchedulingAlgorithm *algorithm = &config->algorithms[i];
+        algorithms[i] = initSchedulingAlgorithm(algorithm->type, algorithm->RRSliceLimit,
+                                                algorithm->executiontTimeLimit, algorithm->ageLimit);
+        if (!algorithms[i])
+        {
+            fprintf(stderr, "Error: could not allocate memory for a sweep configuration\n");
+            for (int j = 0; j < i; j++)
+                freeSchedulingAlgorithm(algorithms[j]);
+            free(algorithms);
+            freeStats(stats);
+            return;
+        }
+    }
+
+    //the warnings are kept with the configuration, to be printed in order with the results
+    SimulationOptions options = sweep->options;
+    options.stopWarning = config->stopWarning;
+    //a configuration that could not be simulated stays not done: its results are reported as an error
+    if (launchSimulation(sweep->workload, algorithms, config->nbQueues, config->coreCount, NULL, stats, &options))
+    {
+        getStatsSummary(stats, &config->summary);
+        config->done = true;
+    }
+
+    freeStats(stats);
+}
+
+static void describeConfig(const SweepConfig *config, char *description, size_t size)
+{
+    size_t length = 0;
+    description[0] = '\0';
+    for (int i = 0; i < config->nbQueues && length < size; i++)
+    {
+        const SchedulingAlgorithm *algorithm = &config->algorithms[i];
+        length += snprintf(description + length, size - length, "%s%s", i > 0 ? " > " : "", getAlgorithmTypeName(algorithm->type));
+        if (length < size && algorithm->type == RR)
+            length += snprintf(description + length, size - length, " slice=%" PRId64, algorithm->RRSliceLimit);
+        if (length < size && algorithm->executiontTimeLimit != NO_LIMIT)
+            length += snprintf(description + length, size - length, " limit=%" PRId64, algorithm->executiontTimeLimit);
+        if (length < size && algorithm->ageLimit != NO_LIMIT)
+            length += snprintf(description + length, size - length, " age=%" PRId64, algorithm->ageLimit);
+    }
+}
+
+static void printSweepResults(const Sweep *sweep)
+{
+    puts("CONFIG | CORES | FINISHED | MAKESPAN | TURNAROUND | WAITING | RESPONSE | C. SWITCHES | READY QUEUES");
+
+    char description[MAX_CONFIG_DESCRIPTION];
+    for (int i = 0; i < sweep->nbConfigs; i++)
+    {
+        const SweepConfig *config = &sweep->configs[i];
+        describeConfig(config, description, sizeof(description));
+        if (!config->done)
+        {
+            printf("%6d | %5d | %8s | %8s | %10s | %7s | %8s | %11s | %s\n",
+                   i, config->coreCount, "error", "-", "-", "-", "-", "-", description);
+            continue;
+        }
+
+        const StatsSummary *summary = &config->summary;
+        printf("%6d | %5d | %4d/%-3d | %8" PRId64 " | %10.2f | %7.2f | %8.2f | %11" PRId64 " | %s\n",
+               i, config->coreCount, summary->nbProcessesFinished, summary->nbProcesses,
+               summary->makespan, summary->meanTurnaroundTime, summary->meanWaitingTime,
+               summary->meanResponseTime, summary->nbContextSwitches, description);
+    }
+
+    //the warnings of the workers, in the order of the configurations whatever the number of threads
+    fflush(stdout);
+    for (int i = 0; i < sweep->nbConfigs; i++)
+    {
+        if (sweep->configs[i].stopWarning[0] != '\0')
+            fprintf(stderr, "Warning: config %d: %s\n", i, sweep->configs[i].stopWarning);
+    }
+}
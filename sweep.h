@@ -0,0 +1,56 @@
+#ifndef sweep_h
+#define sweep_h
+
+#include <stdbool.h>
+
+#include "simulation.h"
+
+/* ------------------------------ Sweep struct ----------------------------- */
+
+/*
+ * The Sweep struct describes a grid of configurations (core counts, ready
+ * queue layouts and, for each ready queue, lists of algorithms and limits) to
+ * simulate on the same workload. Every combination of the values is
+ * simulated, in parallel on a pool of threads.
+ */
+typedef struct Sweep_t Sweep;
+
+
+/* -------------------------- init/free functions -------------------------- */
+
+/**
+ * Parse the command line arguments of the sweep mode:
+ * INPUT_FILE --sweep -c NB_CORES_LIST LAYOUT [LAYOUT ...] with
+ * LAYOUT = -q NB_READY_QUEUES SWEEP_OPTIONS_QUEUE_0 [SWEEP_OPTIONS_QUEUE_1] [...]
+ * where each value of the algorithm options can be a comma-separated list.
+ *
+ * @param argc: the number of arguments
+ * @param argv: the arguments
+ *
+ * @return the new Sweep struct, or NULL if the arguments are invalid
+ */
+Sweep *parseSweepArguments(int argc, const char *argv[]);
+
+/**
+ * Free the memory of the given Sweep struct.
+ *
+ * @param sweep: the Sweep struct to free
+ */
+void freeSweep(Sweep *sweep);
+
+
+/* ---------------------------- sweep functions ---------------------------- */
+
+/**
+ * Simulate every configuration of the sweep on the given workload, in
+ * parallel, and print a table with the summary of the stats of each
+ * configuration (in the order of the grid, whatever the thread count).
+ *
+ * @param sweep: the sweep to run
+ * @param workload: the workload to simulate, shared by all the simulations
+ *
+ * @return true on success, false if the simulations could not be launched
+ */
+bool runSweep(Sweep *sweep, const Workload *workload);
+
+#endif // sweep_h
@@ -0,0 +1,38 @@
+#!/bin/sh
+# Runs every input file of test_files with several configurations, once with
+# unit ticks and once with --event-driven, and fails if the outputs differ.
+#
+# usage: compare_modes.sh [cpuScheduler binary]
+
+SCHEDULER=${1:-./cpuScheduler}
+DIR=$(dirname "$0")
+
+failures=0
+runs=0
+for input in "$DIR"/*.txt
+do
+    while read -r config
+    do
+        runs=$((runs + 1))
+        # a run stopped by a budget still has to stop at the same time in both modes
+        ticks=$("$SCHEDULER" "$input" $config --max-time=1000 2>&1)
+        events=$("$SCHEDULER" "$input" $config --max-time=1000 --event-driven 2>&1)
+        if [ "$ticks" != "$events" ]
+        then
+            failures=$((failures + 1))
+            echo "FAIL: $input $config"
+        fi
+    done <<EOF
+-c 1 -q 1 --algorithm=FCFS
+-c 2 -q 1 --algorithm=RR --RRSlice=3
+-c 1 -q 1 --algorithm=SJF
+-c 3 -q 1 --algorithm=PRIORITY
+-c 1 -q 2 --algorithm=RR --RRSlice=2 --limit=4 --algorithm=FCFS --age=5
+-c 2 -q 3 --algorithm=PRIORITY --limit=3 --algorithm=RR --RRSlice=2 --limit=5 --age=6 --algorithm=SJF --age=4
+-c 1 -q 3 --algorithm=RR --RRSlice=1 --limit=2 --algorithm=PRIORITY --limit=4 --age=3 --algorithm=FCFS --age=2
+-c 4 -q 2 --algorithm=SJF --limit=2 --algorithm=PRIORITY --age=3 --per-core-queues
+EOF
+done
+
+echo "$failures of $runs runs differ between unit ticks and --event-driven"
+[ "$failures" -eq 0 ]
@@ -1,6 +1,13 @@
 // You can use these methods and add new ones not related to the simulation if
 // you want.
 
+#define _POSIX_C_SOURCE 199309L // clock_gettime, sysconf
+
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
 #include "utils.h"
 
 void printVerbose(const char *str)
@@ -16,7 +23,126 @@ int min(int a, int b)
     return a < b ? a : b;
 }
 
+int64_t min64(int64_t a, int64_t b)
+{
+    return a < b ? a : b;
+}
+
+int64_t max64(int64_t a, int64_t b)
+{
+    return a > b ? a : b;
+}
+
 int min3(int a, int b, int c)
 {
     return min(min(a, b), c);
 }
+
+double getWallClockTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int findFirstSet64(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(word);
+#else
+    int index = 0;
+    while (!(word & 1))
+    {
+        word >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+int findLastSet64(uint64_t word)
+{
+#ifdef __GNUC__
+    return 63 - __builtin_clzll(word);
+#else
+    int index = 63;
+    while (!(word >> 63))
+    {
+        word <<= 1;
+        index--;
+    }
+    return index;
+#endif
+}
+
+int countSetBits64(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word; word &= word - 1)
+        count++;
+    return count;
+#endif
+}
+
+unsigned int getHashHome(int key, int size)
+{
+    uint32_t hash = (uint32_t) key * 2654435761u;
+    // the top log2(size) bits of the hash
+    return (unsigned int) (((uint64_t) hash * (uint32_t) size) >> 32);
+}
+
+bool parseOptionValue(const char *arg, int64_t minValue, int64_t maxValue, int64_t *value)
+{
+    char *end;
+    errno = 0;
+    long long parsed = strtoll(arg, &end, 10);
+    if (end == arg || *end != '\0' || errno == ERANGE || parsed < minValue || parsed > maxValue)
+    {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+int getOnlineCoreCount(void)
+{
+    long nbOnlineCores = sysconf(_SC_NPROCESSORS_ONLN);
+    return nbOnlineCores > 0 ? (int) nbOnlineCores : 1;
+}
+
+void seedRandomGenerator(RandomGenerator *generator, unsigned int seed)
+{
+    // state[i] = 16807 * state[i - 1] % (2^31 - 1), Schrage's method to avoid overflows
+    int32_t word = seed == 0 ? 1 : (int32_t) seed;
+    generator->state[0] = (uint32_t) word;
+    for (int i = 1; i < RANDOM_STATE_SIZE; i++)
+    {
+        int32_t hi = word / 127773;
+        int32_t lo = word % 127773;
+        word = 16807 * lo - 2836 * hi;
+        if (word < 0)
+        {
+            word += 2147483647;
+        }
+        generator->state[i] = (uint32_t) word;
+    }
+    generator->front = RANDOM_SEPARATION;
+    generator->rear = 0;
+
+    // discard the first values, strongly correlated with the seed
+    for (int i = 0; i < 10 * RANDOM_STATE_SIZE; i++)
+    {
+        nextRandom(generator);
+    }
+}
+
+int nextRandom(RandomGenerator *generator)
+{
+    uint32_t value = generator->state[generator->front] += generator->state[generator->rear];
+    generator->front = (generator->front + 1) % RANDOM_STATE_SIZE;
+    generator->rear = (generator->rear + 1) % RANDOM_STATE_SIZE;
+    return (int) (value >> 1);
+}
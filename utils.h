@@ -1,8 +1,31 @@
+#ifndef utils_h
+#define utils_h
+
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #define VERBOSE 0
 
+#define RANDOM_STATE_SIZE 31
+#define RANDOM_SEPARATION 3
+
+/*
+ * The RandomGenerator struct is the state of a pseudo-random number
+ * generator. Each user owns its generator, so that the sequences do not
+ * depend on each other (nor on the threads). It is the additive feedback
+ * generator of the glibc rand(): for the same seed, it gives the same
+ * sequence as srand(seed) followed by calls to rand().
+ */
+typedef struct RandomGenerator_t RandomGenerator;
+
+struct RandomGenerator_t
+{
+    uint32_t state[RANDOM_STATE_SIZE];
+    int front;
+    int rear;
+};
+
 /**
  * Prints a verbose message to the console.
  *
@@ -21,6 +44,26 @@ void printVerbose(const char *str);
 int min(int a, int b);
 
 
+/**
+ * Returns the minimum of two 64-bit integers (used for times).
+ *
+ * @param a The first integer.
+ * @param b The second integer.
+ * @return The minimum of the two integers.
+ */
+int64_t min64(int64_t a, int64_t b);
+
+
+/**
+ * Returns the maximum of two 64-bit integers (used for times).
+ *
+ * @param a The first integer.
+ * @param b The second integer.
+ * @return The maximum of the two integers.
+ */
+int64_t max64(int64_t a, int64_t b);
+
+
 /**
  * Returns the minimum value among three integers.
  *
@@ -30,3 +73,90 @@ int min(int a, int b);
  * @return The minimum value among the three integers.
  */
 int min3(int a, int b, int c);
+
+
+/**
+ * Returns the index of the lowest set bit of a 64-bit word (find first set).
+ *
+ * @param word The word, which must not be 0.
+ * @return The index of the lowest set bit, from 0 to 63.
+ */
+int findFirstSet64(uint64_t word);
+
+/**
+ * Returns the index of the highest set bit of a 64-bit word (find last set).
+ *
+ * @param word The word, which must not be 0.
+ * @return The index of the highest set bit, from 0 to 63.
+ */
+int findLastSet64(uint64_t word);
+
+/**
+ * Returns the number of set bits of a 64-bit word (population count).
+ *
+ * @param word The word.
+ * @return The number of set bits, from 0 to 64.
+ */
+int countSetBits64(uint64_t word);
+
+
+/**
+ * Returns the home slot of a key in an open-addressing hash table, by
+ * Fibonacci hashing: the key is multiplied by 2^32 / phi and the high bits
+ * of the product are kept, since its low bits only depend on the low bits
+ * of the key (keys with a power of 2 stride would share a few slots).
+ *
+ * @param key The key.
+ * @param size The number of slots of the table, a power of 2.
+ * @return The home slot of the key, from 0 to size - 1.
+ */
+unsigned int getHashHome(int key, int size);
+
+
+/**
+ * Parses the value of a command line option: a whole number in the given
+ * range, without anything after it.
+ *
+ * @param arg The value to parse.
+ * @param minValue The minimum value allowed.
+ * @param maxValue The maximum value allowed.
+ * @param value The parsed value (only set on success).
+ * @return True on success, false if the value is invalid.
+ */
+bool parseOptionValue(const char *arg, int64_t minValue, int64_t maxValue, int64_t *value);
+
+
+/**
+ * Returns the current wall-clock time, in seconds, from an arbitrary origin.
+ *
+ * @return The current wall-clock time in seconds.
+ */
+double getWallClockTime(void);
+
+
+/**
+ * Returns the number of processor cores currently online.
+ *
+ * @return The number of online cores (at least 1).
+ */
+int getOnlineCoreCount(void);
+
+
+/**
+ * Seeds the given pseudo-random number generator (as srand for rand).
+ *
+ * @param generator The generator to seed.
+ * @param seed The seed (0 is replaced by 1).
+ */
+void seedRandomGenerator(RandomGenerator *generator, unsigned int seed);
+
+
+/**
+ * Returns the next pseudo-random number of the given generator.
+ *
+ * @param generator The generator.
+ * @return A pseudo-random number between 0 and 2^31 - 1.
+ */
+int nextRandom(RandomGenerator *generator);
+
+#endif // utils_h